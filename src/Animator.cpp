@@ -0,0 +1,46 @@
+#include "Animator.hpp"
+
+#include <algorithm>
+
+void Animator::start(Animated& target, std::size_t channel, sf::Time duration)
+{
+    const auto isSame = [&](const Tween& tween) { return tween.target == &target && tween.channel == channel; };
+    const auto it     = std::find_if(m_tweens.begin(), m_tweens.end(), isSame);
+    if (it != m_tweens.end())
+        *it = {&target, channel, sf::Time::Zero, duration};
+    else
+        m_tweens.push_back({&target, channel, sf::Time::Zero, duration});
+}
+
+bool Animator::update(sf::Time frameTime)
+{
+    for (std::size_t i = 0; i < m_tweens.size();)
+    {
+        auto&      tween    = m_tweens[i];
+        const auto progress = std::min(1.f, tween.elapsed / tween.duration);
+        tween.target->animate(tween.channel, progress);
+
+        if (progress < 1.f)
+        {
+            tween.elapsed += frameTime;
+            ++i;
+        }
+        else
+        {
+            tween = m_tweens.back();
+            m_tweens.pop_back();
+        }
+    }
+
+    return isAnimating();
+}
+
+bool Animator::isAnimating() const
+{
+    return !m_tweens.empty();
+}
+
+std::size_t Animator::getAnimationCount() const
+{
+    return m_tweens.size();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <SFML/System/Time.hpp>
+
+#include <vector>
+
+#include <cstddef>
+
+// Something drawn differently while one of its animations runs, channel tells its animations apart
+class Animated
+{
+public:
+    virtual ~Animated() = default;
+
+    // Progress goes from 0 when the animation starts to 1, the last call of an animation is always with 1
+    virtual void animate(std::size_t channel, float progress) = 0;
+};
+
+// Advances the running animations in one pass, objects which are not animated cost nothing
+class Animator
+{
+public:
+    // Starts an animation, or restarts it if the channel of target is already animated
+    void start(Animated& target, std::size_t channel, sf::Time duration);
+
+    // Returns true while animations are running
+    bool update(sf::Time frameTime);
+
+    bool isAnimating() const;
+
+    std::size_t getAnimationCount() const;
+
+private:
+    struct Tween
+    {
+        Animated*   target;
+        std::size_t channel;
+        sf::Time    elapsed;
+        sf::Time    duration;
+    };
+
+    std::vector<Tween> m_tweens; // running animations only, in no particular order
+};
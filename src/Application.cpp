@@ -1,33 +1,57 @@
 #include "Application.hpp"
 
+#include "TextBuilder.hpp"
+#include "allocations.hpp"
 #include "ranges.hpp"
 #include "strings.hpp"
 
 #include <SFML/Window/VideoMode.hpp>
 
+#include <SFML/System/Sleep.hpp>
+
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <string>
 
 namespace
 {
+// Number of events of the same kind which were coalesced into one panel update
+void appendBurst(TextBuilder& text, unsigned int burst)
+{
+    if (burst < 2)
+        return;
+
+    text += "\t(";
+    text += burst;
+    text += " this frame)";
+}
+
 template <typename KeyEventType>
-sf::String keyEventDescription(sf::String text, const KeyEventType& keyEvent)
+TextBuilder keyEventDescription(FrameArena&         arena,
+                                const char*         title,
+                                const KeyEventType& keyEvent,
+                                unsigned int        burst = 1)
 {
+    auto text = TextBuilder{arena};
+    text += title;
+    appendBurst(text, burst);
     text += "\n\nCode:\t\t";
-    text += std::to_string(static_cast<int>(keyEvent.code));
+    text += static_cast<int>(keyEvent.code);
     text += "\tsf::Keyboard::";
     text += keyIdentifier(keyEvent.code);
     text += "\nScancode:\t";
-    text += std::to_string(static_cast<int>(keyEvent.scancode));
+    text += static_cast<int>(keyEvent.scancode);
     text += "\tsf::Keyboard::";
     text += scancodeIdentifier(keyEvent.scancode);
     text += "\nDescription:\t";
     text += sf::Keyboard::getDescription(keyEvent.scancode);
     text += "\nLocalized:\t";
-    text += std::to_string(static_cast<int>(sf::Keyboard::localize(keyEvent.scancode)));
+    text += static_cast<int>(sf::Keyboard::localize(keyEvent.scancode));
     text += "\tsf::Keyboard::";
     text += keyIdentifier(sf::Keyboard::localize(keyEvent.scancode));
     text += "\nDelocalized:\t";
-    text += std::to_string(static_cast<int>(sf::Keyboard::delocalize(keyEvent.code)));
+    text += static_cast<int>(sf::Keyboard::delocalize(keyEvent.code));
     text += "\tsf::Keyboard::";
     text += scancodeIdentifier(sf::Keyboard::delocalize(keyEvent.code));
     text += "\n\n";
@@ -35,23 +59,63 @@ sf::String keyEventDescription(sf::String text, const KeyEventType& keyEvent)
     return text;
 }
 
-sf::String textEventDescription(const sf::Event::TextEntered& textEntered)
+TextBuilder textEventDescription(FrameArena&                   arena,
+                                 const sf::Event::TextEntered& textEntered,
+                                 const EventRecord&            record,
+                                 unsigned int                  burst = 1)
 {
-    sf::String text = "Text Entered";
+    auto text = TextBuilder{arena};
+    text += "Text Entered";
+    appendBurst(text, burst);
     text += "\n\nunicode:\t";
-    text += std::to_string(textEntered.unicode);
+    text += static_cast<std::uint32_t>(textEntered.unicode);
     text += "\t";
     text += static_cast<char32_t>(textEntered.unicode);
+    text += "\nKey Pressed:\t";
+    if (record.flags & EventRecord::TextWithoutPress)
+    {
+        text += "none";
+    }
+    else
+    {
+        text += record.flags & EventRecord::Composed ? "composed, last " : "";
+        text += "sf::Keyboard::";
+        text += scancodeIdentifier(static_cast<sf::Keyboard::Scancode>(record.scancode));
+        text += "\t";
+        text += record.latency;
+        text += " us before";
+    }
     text += "\n\n";
 
     return text;
 }
 
+TextBuilder missingTextDescription(FrameArena& arena, const EventRecord& record)
+{
+    auto text = TextBuilder{arena};
+    text += "Text Missing";
+    text += "\n\nScancode:\t";
+    text += record.scancode;
+    text += "\tsf::Keyboard::";
+    text += scancodeIdentifier(static_cast<sf::Keyboard::Scancode>(record.scancode));
+    text += "\nPressed at:\t";
+    text += record.timestamp / 1000;
+    text += " ms\n\n";
+
+    return text;
+}
+
 template <typename ButtonEventType>
-sf::String buttonEventDescription(sf::String text, const ButtonEventType& buttonEvent)
+TextBuilder buttonEventDescription(FrameArena&            arena,
+                                   const char*            title,
+                                   const ButtonEventType& buttonEvent,
+                                   unsigned int           burst = 1)
 {
+    auto text = TextBuilder{arena};
+    text += title;
+    appendBurst(text, burst);
     text += "\n\nButton:\t";
-    text += std::to_string(static_cast<int>(buttonEvent.button));
+    text += static_cast<int>(buttonEvent.button);
     text += "\tsf::Mouse::";
     text += buttonIdentifier(buttonEvent.button);
     text += "\n\n";
@@ -59,216 +123,737 @@ sf::String buttonEventDescription(sf::String text, const ButtonEventType& button
     return text;
 }
 
-sf::String buttonDescription(sf::Mouse::Button button, bool buttonPressed)
+void appendButtonDescription(TextBuilder& text, sf::Mouse::Button button, bool buttonPressed)
 {
-    sf::String text = std::to_string(static_cast<int>(button)) + " / ";
+    text += static_cast<int>(button);
+    text += " / ";
     text += "sf::Mouse::";
     text += buttonIdentifier(button);
     text += buttonPressed ? "\tPressed" : "";
     text += "\n";
+}
+
+TextBuilder findingDescription(FrameArena& arena, const StateSampler::Finding& finding)
+{
+    static constexpr const char* kinds[] = {"Missed Press", "Missing Release", "Phantom Press", "Phantom Release"};
+
+    auto text = TextBuilder{arena};
+    text += "State Sampler: ";
+    text += kinds[static_cast<int>(finding.kind)];
+    if (const auto* scancode = std::get_if<sf::Keyboard::Scancode>(&finding.input))
+    {
+        text += "\n\nScancode:\t";
+        text += static_cast<int>(*scancode);
+        text += "\tsf::Keyboard::";
+        text += scancodeIdentifier(*scancode);
+    }
+    else if (const auto* button = std::get_if<sf::Mouse::Button>(&finding.input))
+    {
+        text += "\n\nButton:\t";
+        text += static_cast<int>(*button);
+        text += "\tsf::Mouse::";
+        text += buttonIdentifier(*button);
+    }
+    text += "\nTime:\t\t";
+    text += finding.timestamp.asMilliseconds();
+    text += " ms\n\n";
 
     return text;
 }
 
-template <typename KeyEventType>
-bool seemsStrange(const KeyEventType& keyEvent)
+TextBuilder watchdogDescription(FrameArena& arena, const EventRecord& record)
 {
-    return keyEvent.code == sf::Keyboard::Key::Unknown || keyEvent.scancode == sf::Keyboard::Scan::Unknown ||
-           sf::Keyboard::getDescription(keyEvent.scancode) == "" ||
-           sf::Keyboard::localize(keyEvent.scancode) != keyEvent.code ||
-           sf::Keyboard::delocalize(keyEvent.code) != keyEvent.scancode;
-}
+    static constexpr const char* kinds[] = {"Stuck Press", "Missing Release", "Release Without Press", "Release Lost"};
+
+    auto text = TextBuilder{arena};
+    text += "Watchdog: ";
+    text += kinds[static_cast<int>(record.type) - static_cast<int>(EventRecord::Type::StuckPress)];
+    if (record.scancode >= 0)
+    {
+        text += "\n\nScancode:\t";
+        text += record.scancode;
+        text += "\tsf::Keyboard::";
+        text += scancodeIdentifier(static_cast<sf::Keyboard::Scancode>(record.scancode));
+    }
+    else
+    {
+        text += "\n\nButton:\t";
+        text += record.code;
+        text += "\tsf::Mouse::";
+        text += buttonIdentifier(static_cast<sf::Mouse::Button>(record.code));
+    }
+    text += "\nTime:\t\t";
+    text += record.timestamp / 1000;
+    text += " ms\n\n";
 
-static constexpr auto textSize{14u};
-static constexpr auto space{4u};
-static constexpr auto lineSize{textSize + space};
+    return text;
+}
 
-float getSpacingFactor(const sf::Font& font)
+TextBuilder chatterDescription(FrameArena& arena, sf::Keyboard::Scancode scancode, sf::Time sinceRelease)
 {
-    return static_cast<float>(lineSize) / font.getLineSpacing(textSize);
+    auto text = TextBuilder{arena};
+    text += "Switch Chatter";
+    text += "\n\nScancode:\t";
+    text += static_cast<int>(scancode);
+    text += "\tsf::Keyboard::";
+    text += scancodeIdentifier(scancode);
+    text += "\nReleased:\t";
+    text += sinceRelease.asMicroseconds();
+    text += " us before\n\n";
+
+    return text;
 }
 
-ShinyText makeShinyText(const sf::Font& font, const sf::String& string, const sf::Vector2f& position)
+TextBuilder patternDescription(FrameArena&                    arena,
+                               const PatternMatcher&          matcher,
+                               const PatternMatcher::Result& result,
+                               unsigned int                   burst = 1)
 {
-    auto text = ShinyText{font, string, textSize};
-    text.setLineSpacing(getSpacingFactor(font));
-    text.setOutlineThickness(2.f);
-    text.setPosition(position);
+    static constexpr const char* kinds[] = {
+        "Pattern Matched", "Pattern Too Slow", "Chord Too Slow", "Pattern Broken", "Pattern Timed Out"};
+
+    const auto& pattern = matcher.getPattern(result.pattern);
+
+    auto text = TextBuilder{arena};
+    text += kinds[static_cast<int>(result.kind)];
+    appendBurst(text, burst);
+    text += "\n\nPattern:\t";
+    text += pattern.name.c_str();
+    text += "\nSteps:\t\t";
+    text += result.steps;
+    text += " of ";
+    text += pattern.steps.size();
+    text += "\nDuration:\t";
+    text += result.duration.asMilliseconds();
+    text += " ms\n\n";
 
     return text;
 }
 
-sf::Text makeText(const sf::Font& font, const sf::String& string, const sf::Vector2f& position)
+// Same shape as the lines of the events in the structured log
+std::string formatPatternResult(const PatternMatcher&          matcher,
+                                const PatternMatcher::Result& result,
+                                sf::Time                       timestamp)
 {
-    auto text = sf::Text{font, string, textSize};
-    text.setLineSpacing(getSpacingFactor(font));
-    text.setPosition(position);
+    static constexpr const char* types[] = {
+        "PatternMatched", "PatternTooSlow", "ChordTooSlow", "PatternBroken", "PatternTimedOut"};
+
+    auto line = std::string{"{\"time\":"};
+    line += std::to_string(timestamp.asMicroseconds());
+    line += ",\"type\":\"";
+    line += types[static_cast<int>(result.kind)];
+    line += "\",\"pattern\":\"";
+    line += matcher.getPattern(result.pattern).name;
+    line += "\",\"steps\":" + std::to_string(result.steps);
+    line += ",\"duration\":" + std::to_string(result.duration.asMicroseconds());
+    line += "}\n";
+
+    return line;
+}
 
-    return text;
+std::string formatLatency(const EvdevReader::Latency& latency)
+{
+    auto line = std::string{"{\"time\":"};
+    line += std::to_string(latency.eventTime.asMicroseconds());
+    line += ",\"type\":\"StackLatency\",\"input\":\"";
+    if (const auto* scancode = std::get_if<sf::Keyboard::Scancode>(&latency.input))
+        line += scancodeIdentifier(*scancode);
+    else
+        line += buttonIdentifier(std::get<sf::Mouse::Button>(latency.input));
+    line += "\",\"pressed\":";
+    line += latency.pressed ? "true" : "false";
+    line += ",\"latency\":" + std::to_string((latency.eventTime - latency.kernelTime).asMicroseconds());
+    line += "}\n";
+
+    return line;
+}
+
+// What makes the record worth a recording of the window, nullptr if nothing does
+const char* anomalyName(const EventRecord& record)
+{
+    if (record.type >= EventRecord::Type::MissingText)
+        return typeName(record.type);
+
+    constexpr auto anomalies = EventRecord::Strange | EventRecord::Chatter | EventRecord::TextWithoutPress;
+    for (std::size_t bit = 0; bit < EventRecord::flagCount; ++bit)
+        if (record.flags & anomalies & (1 << bit))
+            return flagName(bit);
+
+    return nullptr;
 }
 
 } // namespace
 
-bool Resources::open(const std::filesystem::path& resourcesPath)
+bool Resources::open(const std::filesystem::path& resourcesPath, bool loadSounds)
 {
-    return errorSoundBuffer.loadFromFile(resourcesPath / "error_005.ogg") &&
-           pressedSoundBuffer.loadFromFile(resourcesPath / "mouseclick1.ogg") &&
-           releasedSoundBuffer.loadFromFile(resourcesPath / "mouserelease1.ogg") &&
+    return (!loadSounds || (errorSoundBuffer.loadFromFile(resourcesPath / "error_005.ogg") &&
+                            pressedSoundBuffer.loadFromFile(resourcesPath / "mouseclick1.ogg") &&
+                            releasedSoundBuffer.loadFromFile(resourcesPath / "mouserelease1.ogg"))) &&
            font.openFromFile(resourcesPath / "Tuffy.ttf");
 }
 
-Application::Application(const Resources& resources, Encoder encode) :
+void PanelUpdate::add(const sf::Event& event, const EventRecord& record, bool flagged)
+{
+    this->event  = event;
+    this->record = record;
+    this->flagged |= flagged;
+    ++count;
+}
+
+void FrameAllocations::add(bool hadEvents, std::uint64_t allocations)
+{
+    if (hadEvents)
+    {
+        ++busyFrames;
+        busyAllocations += allocations;
+    }
+    else
+    {
+        ++idleFrames;
+        allocatingIdleFrames += allocations != 0;
+        idleAllocations += allocations;
+    }
+}
+
+void FrameAllocations::print(std::ostream& os) const
+{
+    os << "\tHeap allocations of the event thread\n\n";
+    os << "Frames without events: " << idleFrames << ", " << allocatingIdleFrames << " of them allocated, "
+       << idleAllocations << " allocations\n";
+    os << "Frames with events: " << busyFrames << ", " << busyAllocations << " allocations\n\n";
+}
+
+Application::Application(const Resources& resources, Encoder encode, const Settings& settings) :
 window{sf::VideoMode{{1920, 1200}}, "SFML Input Test"},
 resources{resources},
 encode{encode},
-keyPressedText{makeShinyText(resources.font, "Key Pressed", {0, 0})},
-textEnteredText{makeShinyText(resources.font, "Text Entered", {0, 8 * lineSize})},
-keyReleasedText{makeShinyText(resources.font, "Key Released", {0, 12 * lineSize})},
-keyPressedCheckText{makeText(resources.font, "", {0, 20 * lineSize})},
-mouseButtonPressedText{makeShinyText(resources.font, "Mouse Button Pressed", {0, 30 * lineSize})},
-mouseButtonReleasedText{makeShinyText(resources.font, "Mouse Button Released", {0, 34 * lineSize})},
-mouseButtonPressedCheckText{makeText(resources.font, "", {0, 38 * lineSize})}
+showHeatmap{settings.heatmap},
+pipelined{settings.pipelined},
+scene{settings.keyboardLayout},
+renderer{resources.font, settings, window.getSize()}
+{
+    scene.size   = window.getSize();
+    scene.pacing = settings.pacing;
+    mouseAnalyzer.setPosition({1280, 800});
+    eventHistory.setPosition({320, 760});
+
+    if (!settings.logPath.empty())
+        structuredLog.open(settings.logPath);
+
+    if (!settings.archivePath.empty())
+    {
+        if (archive.emplace(settings.archivePath); !archive->isOpen())
+        {
+            std::cout << "Error: cannot open archive file " << settings.archivePath.string() << '\n';
+            archive.reset();
+        }
+    }
+
+    if (!settings.sharedMemoryName.empty())
+        if (sharedState.emplace(settings.sharedMemoryName); !sharedState->isOpen())
+            sharedState.reset();
+
+    if (!settings.socketPath.empty())
+        if (eventServer.emplace(settings.socketPath); !eventServer->isOpen())
+            eventServer.reset();
+
+    if (!settings.soakPath.empty())
+    {
+        if (soakMonitor.emplace(settings.soakPath, sessionClock.getElapsedTime()); !soakMonitor->isOpen())
+        {
+            std::cout << "Error: cannot open soak file " << settings.soakPath.string() << '\n';
+            soakMonitor.reset();
+        }
+    }
+
+    if (!settings.mute)
+    {
+        if (AudioFeedback::isDeviceAvailable())
+            audioFeedback.emplace(sessionClock,
+                                  resources.errorSoundBuffer,
+                                  resources.pressedSoundBuffer,
+                                  resources.releasedSoundBuffer);
+        else
+            std::cout << "Error: no audio playback device, continuing without sound\n";
+    }
+
+    if (!settings.patterns.empty())
+        patternMatcher.emplace(settings.patterns);
+
+    if (settings.evdev || !settings.evdevReplayPath.empty())
+    {
+        evdevReader.emplace(sessionClock, settings.evdevReplayPath, settings.evdevRecordPath);
+        if (!evdevReader->isOpen())
+            evdevReader.reset();
+    }
+
+    if (settings.samplingRate != 0 || settings.rolloverTest)
+        stateSampler.emplace(settings.samplingRate != 0 ? settings.samplingRate : 1000);
+
+    if (settings.rolloverTest)
+        rolloverTest.emplace(*stateSampler, sessionClock.getElapsedTime());
+}
+
+Application::~Application()
 {
-    window.setFramerateLimit(15);
-    keyboardView.setPosition({320, 64});
+    stopRendering();
 }
 
 int Application::run()
 {
-    auto clock = sf::Clock{};
+    const auto frameDuration   = sf::seconds(1.f / static_cast<float>(frameRate));
+    const auto captureInterval = sf::milliseconds(1);
+
+    if (pipelined)
+        (void)startRendering();
+
+    auto frameDeadline = sessionClock.getElapsedTime();
+    auto firstFrame    = true;
     while (window.isOpen())
     {
-        while (const auto event = window.pollEvent())
-            handle(*event);
-        update(clock.restart());
-        render();
+        // Waiting for the display in the event thread would delay the events polled after it, so another thread draws
+        // unless the deadline paces the frames. The deadline is kept when no other thread can draw.
+        if (renderThread.joinable() && !rendering)
+        {
+            stopRendering(); // the render thread couldn't activate the window
+            scene.pacing = Pacing::Deadline;
+        }
+        if (scene.pacing != Pacing::Deadline && !rendering && !startRendering())
+            scene.pacing = Pacing::Deadline;
+        else if (scene.pacing == Pacing::Deadline && !pipelined && rendering)
+            stopRendering();
+
+        // Nothing built during the last frame is referenced anymore
+        frameArena.reset();
+        const auto allocationsBefore = getAllocationCount();
+        auto       events            = std::size_t{0};
+        auto       syntheticEvents   = std::size_t{0};
+
+        // Returns false once nothing is left to capture
+        const auto captureNext = [&](sf::Time now)
+        {
+            if (stateSampler)
+                stateSampler->sample(now);
+
+            if (const auto event = window.pollEvent())
+            {
+                capture(*event, now);
+                ++events;
+            }
+            else if (const auto synthetic = soakMonitor ? soakMonitor->synthesize(now) : std::nullopt)
+            {
+                capture(*synthetic, now, true);
+                ++syntheticEvents;
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        };
+
+        // Events are polled between frames rather than once per frame so that their timestamps stay accurate
+        frameDeadline += frameDuration;
+        for (auto now = sessionClock.getElapsedTime(); now < frameDeadline; now = sessionClock.getElapsedTime())
+            if (!captureNext(now))
+                sf::sleep(std::min(captureInterval, frameDeadline - now));
+        while (captureNext(sessionClock.getElapsedTime()))
+        {
+        }
+
+        // Don't try to catch up on frames which took too long
+        frameDeadline = std::max(frameDeadline, sessionClock.getElapsedTime() - frameDuration);
+
+        const auto frameStart = sessionClock.getElapsedTime();
+        update();
+        publishScene();
+        if (!rendering)
+        {
+            // Acquiring right after publishing, so the scene just built is drawn
+            scenes.acquire();
+            renderer.render(window, scenes.front());
+        }
+
+        // The first frame fills the caches, of the glyphs for instance
+        if (!firstFrame)
+            frameAllocations.add(events + syntheticEvents != 0, getAllocationCount() - allocationsBefore);
+        firstFrame = false;
+
+        if (soakMonitor)
+        {
+            const auto now = sessionClock.getElapsedTime();
+            const auto playingVoices = audioFeedback ? audioFeedback->getPlayingVoices() : 0;
+            soakMonitor->addFrame(now, now - frameStart, events);
+            if (soakMonitor->update(now, renderer.getAnimationCount(), playingVoices))
+                soakMonitor->print(std::cout);
+        }
     }
 
+    keyStatistics.print(std::cout);
+    frameAllocations.print(std::cout);
+    if (audioFeedback)
+        audioFeedback->print(std::cout);
+    if (soakMonitor)
+        soakMonitor->print(std::cout);
+    renderer.print(std::cout);
+    if (patternMatcher)
+        patternMatcher->print(std::cout);
+    if (evdevReader)
+        evdevReader->print(std::cout);
+
     return 0;
 }
 
-void Application::handle(const sf::Event& event)
+void Application::capture(const sf::Event& event, sf::Time timestamp, bool synthetic)
 {
+    // Motion events are only aggregated, at high report rates they would flood the log and the panels
+    if (mouseAnalyzer.record(event, timestamp))
+        return;
+
+    handle(event, timestamp, synthetic);
+}
+
+void Application::handle(const sf::Event& event, sf::Time timestamp, bool synthetic)
+{
+    auto record = makeRecord(event, timestamp);
+    if (!synthetic)
+        check(event, timestamp, record);
+    else if (record)
+        record->flags = EventRecord::Synthetic;
+
+    if (record)
+        publish(*record);
+
+    auto sound = std::optional<AudioFeedback::Sound>{};
     if (event.is<sf::Event::Closed>())
     {
+        stopRendering();
         window.close();
     }
     else if (const auto* resizedEvent = event.getIf<sf::Event::Resized>())
     {
-        window.setView(sf::View(sf::FloatRect({}, sf::Vector2f{resizedEvent->size})));
+        scene.size = resizedEvent->size;
     }
     else if (const auto* keyPressedEvent = event.getIf<sf::Event::KeyPressed>())
     {
-        auto text = keyEventDescription("Key Pressed", *keyPressedEvent);
+        encode(std::cout, keyEventDescription(frameArena, "Key Pressed", *keyPressedEvent).view());
+        keyPressedUpdate.add(event, *record, record->flags & EventRecord::Strange);
 
-        keyPressedText.setString(text);
-        std::cout << encode(text);
-
-        if (seemsStrange(*keyPressedEvent))
-        {
-            keyPressedText.shine(sf::Color::Red);
-            errorSound.play();
-        }
-        else
-        {
-            keyPressedText.shine(sf::Color::Green);
-            pressedSound.play();
-        }
+        sound = record->flags & EventRecord::Strange ? AudioFeedback::Sound::Error : AudioFeedback::Sound::Pressed;
     }
     else if (const auto* textEnteredEvent = event.getIf<sf::Event::TextEntered>())
     {
-        auto text = textEventDescription(*textEnteredEvent);
-
-        textEnteredText.setString(text);
-        std::cout << encode(text);
-
-        textEnteredText.shine();
+        encode(std::cout, textEventDescription(frameArena, *textEnteredEvent, *record).view());
+        textEnteredUpdate.add(event, *record, record->flags & EventRecord::TextWithoutPress);
     }
     else if (const auto* keyReleasedEvent = event.getIf<sf::Event::KeyReleased>())
     {
-        auto text = keyEventDescription("Key Released", *keyReleasedEvent);
-
-        keyReleasedText.setString(text);
-        std::cout << encode(text);
+        encode(std::cout, keyEventDescription(frameArena, "Key Released", *keyReleasedEvent).view());
+        keyReleasedUpdate.add(event, *record, record->flags & EventRecord::Strange);
 
-        if (seemsStrange(*keyReleasedEvent))
-        {
-            keyReleasedText.shine(sf::Color::Red);
-            errorSound.play();
-        }
-        else
-        {
-            keyReleasedText.shine(sf::Color::Green);
-            releasedSound.play();
-        }
+        sound = record->flags & EventRecord::Strange ? AudioFeedback::Sound::Error : AudioFeedback::Sound::Released;
     }
     else if (const auto* mouseButtonPressedEvent = event.getIf<sf::Event::MouseButtonPressed>())
     {
-        auto text = buttonEventDescription("Mouse Button Pressed", *mouseButtonPressedEvent);
+        if (mouseButtonPressedEvent->button == sf::Mouse::Button::Left &&
+            Renderer::getPacingArea().contains(sf::Vector2f{mouseButtonPressedEvent->position}))
+            scene.pacing = nextPacing(scene.pacing);
 
-        mouseButtonPressedText.setString(text);
-        std::cout << encode(text);
+        encode(std::cout, buttonEventDescription(frameArena, "Mouse Button Pressed", *mouseButtonPressedEvent).view());
+        mouseButtonPressedUpdate.add(event, *record, false);
 
-        mouseButtonPressedText.shine();
-        pressedSound.play();
+        sound = AudioFeedback::Sound::Pressed;
     }
     else if (const auto* mouseButtonReleasedEvent = event.getIf<sf::Event::MouseButtonReleased>())
     {
-        auto text = buttonEventDescription("Mouse Button Released", *mouseButtonReleasedEvent);
-
-        mouseButtonReleasedText.setString(text);
-        std::cout << encode(text);
+        encode(std::cout,
+               buttonEventDescription(frameArena, "Mouse Button Released", *mouseButtonReleasedEvent).view());
+        mouseButtonReleasedUpdate.add(event, *record, false);
 
-        mouseButtonReleasedText.shine();
-        releasedSound.play();
+        sound = AudioFeedback::Sound::Released;
     }
 
-    keyboardView.handle(event);
+    if (sound && audioFeedback)
+        audioFeedback->play(*sound, timestamp);
+
+    scene.keyboard.handle(event);
+    eventHistory.handle(event);
+}
+
+void Application::check(const sf::Event& event, sf::Time timestamp, std::optional<EventRecord>& record)
+{
+    if (record)
+        textCorrelator.handle(event, *record);
+
+    inputWatchdog.handle(event, timestamp);
+
+    if (stateSampler)
+        stateSampler->handle(event, timestamp);
+
+    if (rolloverTest)
+        rolloverTest->handle(event, timestamp);
+
+    if (evdevReader)
+        evdevReader->handle(event, timestamp);
+
+    if (patternMatcher)
+        for (const auto& result : patternMatcher->handle(event, timestamp))
+            report(result, timestamp);
+
+    if (const auto bounce = keyStatistics.handle(event, timestamp))
+    {
+        const auto scancode = event.getIf<sf::Event::KeyPressed>()->scancode;
+        encode(std::cout, chatterDescription(frameArena, scancode, *bounce).view());
+        scene.keyboard.mark(scancode, sf::Color::Magenta);
+        record->flags |= EventRecord::Chatter;
+    }
 }
 
-void Application::update(sf::Time frameTime)
+void Application::update()
 {
-    keyPressedText.update(frameTime);
-    textEnteredText.update(frameTime);
-    keyReleasedText.update(frameTime);
-    mouseButtonPressedText.update(frameTime);
-    mouseButtonReleasedText.update(frameTime);
+    showPanelUpdates();
 
     {
-        auto text = sf::String{"isKeyPressed(sf::Keyboard::Key)\n\n"};
+        auto text = TextBuilder{frameArena};
+        text += "isKeyPressed(sf::Keyboard::Key)\n\n";
         for (auto key : keys)
         {
             if (sf::Keyboard::isKeyPressed(key))
-                text += "sf::Keyboard::" + keyIdentifier(key) + "\n";
+            {
+                text += "sf::Keyboard::";
+                text += keyIdentifier(key);
+                text += "\n";
+            }
         }
-        keyPressedCheckText.setString(text);
+        text.copyTo(scene.keyPressedCheck);
     }
 
     {
-        auto text = sf::String{"isButtonPressed(sf::Mouse::Button)\n\n"};
+        auto text = TextBuilder{frameArena};
+        text += "isButtonPressed(sf::Mouse::Button)\n\n";
         for (auto button : buttons)
-            text += buttonDescription(button, sf::Mouse::isButtonPressed(button));
+            appendButtonDescription(text, button, sf::Mouse::isButtonPressed(button));
+
+        text.copyTo(scene.mouseButtonPressedCheck);
+    }
+
+    if (stateSampler)
+    {
+        for (const auto& finding : stateSampler->check(sessionClock.getElapsedTime()))
+        {
+            encode(std::cout, findingDescription(frameArena, finding).view());
+            triggerCapture("State Sampler");
+
+            if (const auto* scancode = std::get_if<sf::Keyboard::Scancode>(&finding.input))
+                scene.keyboard.mark(*scancode, sf::Color::Red);
+            else if (finding.kind == StateSampler::Finding::Kind::MissedPress ||
+                     finding.kind == StateSampler::Finding::Kind::PhantomPress)
+                scene.mouseButtonPressed.shine(sf::Color::Red);
+            else
+                scene.mouseButtonReleased.shine(sf::Color::Red);
+        }
+    }
+
+    for (const auto& missingText : textCorrelator.expire(sessionClock.getElapsedTime()))
+    {
+        auto text = missingTextDescription(frameArena, missingText);
+
+        text.copyTo(scene.textEntered.text);
+        encode(std::cout, text.view());
+        publish(missingText);
+
+        scene.textEntered.shine(sf::Color::Red);
+    }
+
+    for (const auto& finding : inputWatchdog.check(sessionClock.getElapsedTime()))
+    {
+        encode(std::cout, watchdogDescription(frameArena, finding).view());
+        publish(finding);
+
+        if (finding.scancode >= 0)
+            scene.keyboard.mark(static_cast<sf::Keyboard::Scancode>(finding.scancode), sf::Color{255, 128, 0});
+        else if (finding.type == EventRecord::Type::StuckPress)
+            scene.mouseButtonPressed.shine(sf::Color::Red);
+        else
+            scene.mouseButtonReleased.shine(sf::Color::Red);
+    }
+
+    if (rolloverTest)
+    {
+        if (rolloverTest->update(scene.keyboard))
+        {
+            auto ofs = std::ofstream{"rollover.txt"};
+            rolloverTest->print(ofs);
+            rolloverTest->print(std::cout);
+        }
+        scene.rollover = rolloverTest->getInstructions();
+    }
+
+    if (showHeatmap)
+        for (auto scancode : scancodes)
+            scene.keyboard.setHeat(scancode, keyStatistics.getHeat(scancode));
+
+    if (mouseAnalyzer.update(sessionClock.getElapsedTime(), scene.mouse))
+        encode(std::cout, toView(mouseAnalyzer.getSummary()));
+
+    scene.keyboard.update();
+    eventHistory.update(scene.history);
 
-        mouseButtonPressedCheckText.setString(text);
+    if (evdevReader)
+        for (const auto& latency : evdevReader->correlate(sessionClock.getElapsedTime()))
+            if (structuredLog.is_open())
+                structuredLog << formatLatency(latency);
+
+    if (eventServer)
+        eventServer->flush();
+}
+
+void Application::showPanelUpdates()
+{
+    if (const auto& update = keyPressedUpdate; update.count != 0)
+    {
+        const auto& keyPressed = *update.event->getIf<sf::Event::KeyPressed>();
+        keyEventDescription(frameArena, "Key Pressed", keyPressed, update.count).copyTo(scene.keyPressed.text);
+        scene.keyPressed.shine(update.flagged ? sf::Color::Red : sf::Color::Green);
+    }
+
+    if (const auto& update = textEnteredUpdate; update.count != 0)
+    {
+        const auto& textEntered = *update.event->getIf<sf::Event::TextEntered>();
+        textEventDescription(frameArena, textEntered, update.record, update.count).copyTo(scene.textEntered.text);
+        scene.textEntered.shine(update.flagged ? sf::Color::Red : sf::Color::Yellow);
+    }
+
+    if (const auto& update = keyReleasedUpdate; update.count != 0)
+    {
+        const auto& keyReleased = *update.event->getIf<sf::Event::KeyReleased>();
+        keyEventDescription(frameArena, "Key Released", keyReleased, update.count).copyTo(scene.keyReleased.text);
+        scene.keyReleased.shine(update.flagged ? sf::Color::Red : sf::Color::Green);
+    }
+
+    if (const auto& update = mouseButtonPressedUpdate; update.count != 0)
+    {
+        const auto& buttonPressed = *update.event->getIf<sf::Event::MouseButtonPressed>();
+        buttonEventDescription(frameArena, "Mouse Button Pressed", buttonPressed, update.count)
+            .copyTo(scene.mouseButtonPressed.text);
+        scene.mouseButtonPressed.shine(sf::Color::Yellow);
+    }
+
+    if (const auto& update = mouseButtonReleasedUpdate; update.count != 0)
+    {
+        const auto& buttonReleased = *update.event->getIf<sf::Event::MouseButtonReleased>();
+        buttonEventDescription(frameArena, "Mouse Button Released", buttonReleased, update.count)
+            .copyTo(scene.mouseButtonReleased.text);
+        scene.mouseButtonReleased.shine(sf::Color::Yellow);
+    }
+
+    if (lastPatternResult)
+    {
+        patternDescription(frameArena, *patternMatcher, *lastPatternResult, patternResults)
+            .copyTo(scene.patterns.text);
+        scene.patterns.shine(lastPatternResult->kind == PatternMatcher::Result::Kind::Matched ? sf::Color::Green
+                                                                                              : sf::Color::Red);
+        lastPatternResult.reset();
+        patternResults = 0;
+    }
+
+    for (auto* update : {&keyPressedUpdate,
+                         &textEnteredUpdate,
+                         &keyReleasedUpdate,
+                         &mouseButtonPressedUpdate,
+                         &mouseButtonReleasedUpdate})
+        *update = {};
+}
+
+void Application::report(const PatternMatcher::Result& result, sf::Time timestamp)
+{
+    encode(std::cout, patternDescription(frameArena, *patternMatcher, result).view());
+
+    if (structuredLog.is_open())
+        structuredLog << formatPatternResult(*patternMatcher, result, timestamp);
+
+    lastPatternResult = result;
+    ++patternResults;
+}
+
+void Application::publish(const EventRecord& record)
+{
+    eventHistory.push(record);
+
+    if (structuredLog.is_open())
+        structuredLog << format(record);
+
+    if (archive)
+        archive->write(record);
+
+    // The shared state is of the devices, which didn't press the synthetic keys
+    if (sharedState && !(record.flags & EventRecord::Synthetic))
+        sharedState->publish(record);
+
+    if (eventServer)
+        eventServer->publish(record);
+
+    if (const auto* anomaly = anomalyName(record))
+        triggerCapture(anomaly);
+}
+
+void Application::triggerCapture(const char* reason)
+{
+    // The renderer owns the frame recorder, it starts a recording when it sees the counter change
+    scene.captureReason = reason;
+    ++scene.captures;
+}
+
+void Application::publishScene()
+{
+    scenes.back() = scene;
+    scenes.publish();
+}
+
+bool Application::startRendering()
+{
+    // The context can only be active in one thread at a time
+    if (!window.setActive(false))
+    {
+        std::cout << "Error: cannot release the window context, drawing from the event thread\n";
+        return false;
     }
 
-    keyboardView.update(frameTime);
+    rendering    = true;
+    renderThread = std::thread{&Application::renderScenes, this};
+    return true;
 }
 
-void Application::render()
+void Application::renderScenes()
 {
-    window.clear();
+    if (!window.setActive(true))
+    {
+        std::cout << "Error: cannot activate the window in the render thread, drawing from the event thread\n";
+        rendering = false;
+        return;
+    }
 
-    window.draw(keyPressedText);
-    window.draw(textEnteredText);
-    window.draw(keyReleasedText);
-    window.draw(keyPressedCheckText);
+    // Without a deadline the display paces the frames, the last scene is drawn again until another one comes
+    auto acquired = false;
+    while (rendering)
+    {
+        const auto fresh = scenes.acquire();
+        acquired |= fresh;
+        if (fresh || (acquired && scenes.front().pacing != Pacing::Deadline))
+            renderer.render(window, scenes.front());
+        else
+            sf::sleep(sf::milliseconds(1));
+    }
 
-    window.draw(mouseButtonPressedText);
-    window.draw(mouseButtonReleasedText);
-    window.draw(mouseButtonPressedCheckText);
+    (void)window.setActive(false);
+}
 
-    window.draw(keyboardView);
+void Application::stopRendering()
+{
+    if (!renderThread.joinable())
+        return;
 
-    window.display();
+    rendering = false;
+    renderThread.join();
 }
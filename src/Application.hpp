@@ -1,23 +1,51 @@
 #pragma once
 
-#include "KeyboardView.hpp"
-#include "ShinyText.hpp"
+#include "AudioFeedback.hpp"
+#include "EvdevReader.hpp"
+#include "EventHistory.hpp"
+#include "EventRecord.hpp"
+#include "EventServer.hpp"
+#include "FrameArena.hpp"
+#include "InputWatchdog.hpp"
+#include "KeyStatistics.hpp"
+#include "KeyboardLayout.hpp"
+#include "MouseAnalyzer.hpp"
+#include "PatternMatcher.hpp"
+#include "Renderer.hpp"
+#include "RolloverTest.hpp"
+#include "Scene.hpp"
+#include "SessionArchive.hpp"
+#include "SharedStatePublisher.hpp"
+#include "SoakMonitor.hpp"
+#include "StateSampler.hpp"
+#include "TextCorrelator.hpp"
+#include "TripleBuffer.hpp"
 #include "strings.hpp"
 
 #include <SFML/Graphics/Font.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
-#include <SFML/Graphics/Text.hpp>
 
-#include <SFML/Audio/Sound.hpp>
 #include <SFML/Audio/SoundBuffer.hpp>
 
 #include <SFML/Window/Event.hpp>
 
+#include <SFML/System/Clock.hpp>
+
+#include <atomic>
 #include <filesystem>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cstdint>
 
 struct Resources
 {
-    bool open(const std::filesystem::path& resourcesPath);
+    // The sounds are only loaded if they are played
+    bool open(const std::filesystem::path& resourcesPath, bool loadSounds);
 
     sf::SoundBuffer errorSoundBuffer;
     sf::SoundBuffer pressedSoundBuffer;
@@ -25,32 +53,121 @@ struct Resources
     sf::Font        font;
 };
 
+struct Settings
+{
+    unsigned int samplingRate = 0; // Hz, 0 disables the state sampler
+    bool         heatmap      = false;
+    bool         rolloverTest = false; // requires the state sampler, which is started at 1000 Hz if needed
+    bool         mute         = false; // audio is not initialized at all
+    bool         pipelined    = false; // frames are drawn from a thread of their own
+    Pacing       pacing       = Pacing::Deadline;
+
+    std::filesystem::path logPath;          // one JSON line per event, disabled if empty
+    std::filesystem::path archivePath;      // compact columnar copy of the log, disabled if empty
+    std::string           sharedMemoryName; // state and recent events for other processes, disabled if empty
+    std::filesystem::path socketPath;       // Unix domain socket streaming the log lines, disabled if empty
+    std::filesystem::path soakPath;         // resource samples of long runs with synthetic input, disabled if empty
+
+    std::size_t captureBefore = 0; // frames written to captures/ before and after anomalies, disabled if both are 0
+    std::size_t captureAfter  = 0;
+
+    KeyboardLayout       keyboardLayout;
+    std::vector<Pattern> patterns; // chords and sequences recognized in the key presses, disabled if empty
+
+    bool                  evdev = false;   // key and button events are also read from /dev/input to time the stack
+    std::filesystem::path evdevRecordPath; // the kernel events read are written to it, disabled if empty
+    std::filesystem::path evdevReplayPath; // replayed instead of reading the devices, disabled if empty
+};
+
+// Last event of one kind handled during a frame, its panel is laid out and glows once per frame however many came
+struct PanelUpdate
+{
+    void add(const sf::Event& event, const EventRecord& record, bool flagged);
+
+    std::optional<sf::Event> event;
+    EventRecord              record;
+    unsigned int             count   = 0;
+    bool                     flagged = false; // any event of the frame, not only the last one
+};
+
+// Heap allocations of the event thread per frame, frames without events are expected not to allocate at all
+struct FrameAllocations
+{
+    void add(bool hadEvents, std::uint64_t allocations);
+    void print(std::ostream& os) const;
+
+    std::uint64_t idleFrames = 0, allocatingIdleFrames = 0, idleAllocations = 0;
+    std::uint64_t busyFrames = 0, busyAllocations = 0;
+};
+
 class Application
 {
 public:
-    Application(const Resources& resources, Encoder encode);
+    Application(const Resources& resources, Encoder encode, const Settings& settings);
+    ~Application();
 
     int run();
 
 private:
-    void handle(const sf::Event& event);
-    void update(sf::Time frameTime);
-    void render();
+    // Synthetic events are shown, played and published but not checked
+    void capture(const sf::Event& event, sf::Time timestamp, bool synthetic = false);
+    void handle(const sf::Event& event, sf::Time timestamp, bool synthetic);
+    void check(const sf::Event& event, sf::Time timestamp, std::optional<EventRecord>& record);
+    void update();
+    void showPanelUpdates();
+    void report(const PatternMatcher::Result& result, sf::Time timestamp);
+    void publish(const EventRecord& record);
+    void triggerCapture(const char* reason);
+
+    // The render thread draws the last scene published, or the scene is drawn right away without one. It runs when
+    // pipelined and whenever the display paces the frames.
+    void publishScene();
+    bool startRendering();
+    void renderScenes();
+    void stopRendering();
 
 private:
     sf::RenderWindow window;
     const Resources& resources;
     const Encoder    encode;
+    const sf::Clock  sessionClock;
+    const bool       showHeatmap;
+    const bool       pipelined;
+    std::ofstream    structuredLog;
+    FrameArena       frameArena{1 << 20}; // text built while handling events and updating the panels
+
+    FrameAllocations frameAllocations;
+
+    std::optional<SessionArchive::Writer> archive;
+    std::optional<SharedStatePublisher>   sharedState;
+    std::optional<EventServer>            eventServer;
+    std::optional<SoakMonitor>            soakMonitor;
+
+    std::optional<StateSampler>   stateSampler;
+    KeyStatistics                 keyStatistics;
+    TextCorrelator                textCorrelator;
+    InputWatchdog                 inputWatchdog;
+    std::optional<PatternMatcher> patternMatcher;
+    std::optional<EvdevReader>    evdevReader;
+
+    std::optional<AudioFeedback> audioFeedback;
+
+    // Every event is logged, counted and checked in handle, the panels only show the last one of each kind
+    PanelUpdate keyPressedUpdate, textEnteredUpdate, keyReleasedUpdate;
+    PanelUpdate mouseButtonPressedUpdate, mouseButtonReleasedUpdate;
 
-    sf::Sound errorSound{resources.errorSoundBuffer};
-    sf::Sound pressedSound{resources.pressedSoundBuffer};
-    sf::Sound releasedSound{resources.releasedSoundBuffer};
+    std::optional<PatternMatcher::Result> lastPatternResult;
+    unsigned int                          patternResults = 0;
 
-    ShinyText keyPressedText, textEnteredText, keyReleasedText;
-    sf::Text  keyPressedCheckText;
+    MouseAnalyzer mouseAnalyzer{frameArena};
+    EventHistory  eventHistory{frameArena};
 
-    ShinyText mouseButtonPressedText, mouseButtonReleasedText;
-    sf::Text  mouseButtonPressedCheckText;
+    std::optional<RolloverTest> rolloverTest;
 
-    KeyboardView keyboardView{resources.font};
+    // Only the scenes are shared with the render thread, the renderer is left to it while it runs
+    Scene               scene;
+    TripleBuffer<Scene> scenes{scene};
+    Renderer            renderer;
+    std::atomic<bool>   rendering{false};
+    std::thread         renderThread;
 };
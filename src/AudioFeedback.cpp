@@ -0,0 +1,137 @@
+#include "AudioFeedback.hpp"
+
+#include <SFML/Audio/PlaybackDevice.hpp>
+
+#include <SFML/System/Sleep.hpp>
+
+#include <algorithm>
+
+AudioFeedback::AudioFeedback(const sf::Clock&       clock,
+                             const sf::SoundBuffer& errorBuffer,
+                             const sf::SoundBuffer& pressedBuffer,
+                             const sf::SoundBuffer& releasedBuffer) :
+m_clock{clock},
+m_buffers{&errorBuffer, &pressedBuffer, &releasedBuffer}
+{
+    m_lastStart.fill(-m_minInterval.asMicroseconds());
+
+    m_voices.reserve(voiceCount);
+    for (std::size_t i = 0; i < voiceCount; ++i)
+        m_voices.push_back({sf::Sound{pressedBuffer}});
+
+    m_thread = std::thread{&AudioFeedback::run, this};
+}
+
+AudioFeedback::~AudioFeedback()
+{
+    m_running = false;
+    m_thread.join();
+}
+
+void AudioFeedback::play(Sound sound, sf::Time requested)
+{
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) == queueSize)
+    {
+        m_dropped++;
+        return;
+    }
+
+    m_queue[tail % queueSize] = {sound, requested.asMicroseconds()};
+    m_tail.store(tail + 1, std::memory_order_release);
+}
+
+std::size_t AudioFeedback::getPlayingVoices() const
+{
+    return m_playingVoices;
+}
+
+void AudioFeedback::print(std::ostream& os) const
+{
+    const auto count = m_latencyCount.load();
+
+    os << "\tAudio feedback\n\n";
+    os << "Played: " << m_played << ", rate limited: " << m_limited << ", dropped: " << m_dropped
+       << ", never started: " << m_unconfirmed << '\n';
+    if (count != 0)
+        os << "Latency from event to sound: " << m_latencySum / static_cast<std::int64_t>(count) / 1000
+           << " ms on average, " << m_latencyMax / 1000 << " ms at most\n";
+    os << '\n';
+}
+
+bool AudioFeedback::isDeviceAvailable()
+{
+    return sf::PlaybackDevice::getDefaultDevice().has_value();
+}
+
+void AudioFeedback::run()
+{
+    const auto period = sf::milliseconds(1);
+    while (m_running)
+    {
+        const auto tail = m_tail.load(std::memory_order_acquire);
+        for (auto head = m_head.load(std::memory_order_relaxed); head != tail; ++head)
+        {
+            const auto& [sound, requested] = m_queue[head % queueSize];
+            start(sound, requested);
+            m_head.store(head + 1, std::memory_order_release);
+        }
+
+        measure(m_clock.getElapsedTime().asMicroseconds());
+        sf::sleep(period);
+    }
+}
+
+void AudioFeedback::start(Sound sound, std::int64_t requested)
+{
+    const auto index = static_cast<std::size_t>(sound);
+    if (requested - m_lastStart[index] < m_minInterval.asMicroseconds())
+    {
+        m_limited++;
+        return;
+    }
+    m_lastStart[index] = requested;
+
+    // Round robin, the oldest voice is the one most likely to have finished
+    auto& voice = m_voices[m_nextVoice];
+    m_nextVoice = (m_nextVoice + 1) % voiceCount;
+
+    if (0 <= voice.requested)
+        m_unconfirmed++;
+
+    voice.sound.stop();
+    voice.sound.setBuffer(*m_buffers[index]);
+    voice.sound.play();
+    voice.requested = requested;
+    m_played++;
+}
+
+void AudioFeedback::measure(std::int64_t now)
+{
+    auto playing = std::size_t{0};
+    for (auto& voice : m_voices)
+    {
+        const auto status = voice.sound.getStatus();
+        playing += status == sf::SoundSource::Status::Playing;
+        if (voice.requested < 0)
+            continue;
+
+        // The playing offset only moves once the device has consumed samples of the sound
+        if (const auto offset = voice.sound.getPlayingOffset(); sf::Time::Zero < offset)
+        {
+            const auto latency = std::max(std::int64_t{0}, now - offset.asMicroseconds() - voice.requested);
+            m_latencySum += latency;
+            m_latencyMax = std::max(m_latencyMax.load(), latency);
+            m_latencyCount++;
+            voice.requested = -1;
+        }
+        else if (status != sf::SoundSource::Status::Playing ||
+                 m_latencyTimeout.asMicroseconds() < now - voice.requested)
+        {
+            m_unconfirmed++;
+            voice.requested = -1;
+        }
+    }
+
+    m_playingVoices = playing;
+}
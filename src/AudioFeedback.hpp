@@ -0,0 +1,96 @@
+#pragma once
+
+#include <SFML/Audio/Sound.hpp>
+#include <SFML/Audio/SoundBuffer.hpp>
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <atomic>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include <cstdint>
+
+// Plays the feedback sounds from a thread of its own, on a pool of voices so that fast typing and autorepeat don't
+// cut the previous sounds off
+class AudioFeedback
+{
+public:
+    enum class Sound
+    {
+        Error,
+        Pressed,
+        Released,
+    };
+
+    AudioFeedback(const sf::Clock&       clock,
+                  const sf::SoundBuffer& errorBuffer,
+                  const sf::SoundBuffer& pressedBuffer,
+                  const sf::SoundBuffer& releasedBuffer);
+    ~AudioFeedback();
+
+    AudioFeedback(const AudioFeedback&)            = delete;
+    AudioFeedback& operator=(const AudioFeedback&) = delete;
+
+    // Only queues the sound, requested is the time of the event it is the feedback for
+    void play(Sound sound, sf::Time requested);
+
+    std::size_t getPlayingVoices() const;
+
+    // Played, rate limited and dropped sounds and the latency from the event to the first samples being played
+    void print(std::ostream& os) const;
+
+    // False if there is no playback device, sounds would not be heard anyway
+    static bool isDeviceAvailable();
+
+private:
+    void run();
+    void start(Sound sound, std::int64_t requested);
+    void measure(std::int64_t now);
+
+    static constexpr std::size_t soundCount = 3;
+    static constexpr std::size_t voiceCount = 8;
+    static constexpr std::size_t queueSize  = 64;
+
+    // A sound is not restarted more often than this, a faster autorepeat would only make noise
+    static inline const sf::Time m_minInterval = sf::milliseconds(30);
+
+    // Sounds which don't start playing within this time are given up on, as with a null audio device
+    static inline const sf::Time m_latencyTimeout = sf::milliseconds(500);
+
+    struct Request
+    {
+        Sound        sound;
+        std::int64_t requested; // microseconds
+    };
+
+    // Accessed by the audio thread only, after construction
+    struct Voice
+    {
+        sf::Sound    sound;
+        std::int64_t requested = -1; // microseconds, -1 once the latency is measured
+    };
+
+    const sf::Clock&                                     m_clock;
+    const std::array<const sf::SoundBuffer*, soundCount> m_buffers;
+
+    // Single producer, single consumer queue of requests
+    std::array<Request, queueSize> m_queue;
+    std::atomic<std::size_t>       m_head{0}; // next request to play, written by the audio thread
+    std::atomic<std::size_t>       m_tail{0}; // next free slot, written by the event thread
+
+    std::vector<Voice>                   m_voices;
+    std::size_t                          m_nextVoice = 0;
+    std::array<std::int64_t, soundCount> m_lastStart{}; // microseconds
+    std::atomic<std::size_t>             m_playingVoices{0};
+
+    std::atomic<std::uint64_t> m_played{0}, m_limited{0}, m_dropped{0}, m_unconfirmed{0};
+    std::atomic<std::int64_t>  m_latencySum{0}, m_latencyMax{0}; // microseconds
+    std::atomic<std::uint64_t> m_latencyCount{0};
+
+    std::atomic<bool> m_running{true};
+    std::thread       m_thread;
+};
@@ -0,0 +1,651 @@
+#include "EvdevReader.hpp"
+
+#include <SFML/System/Sleep.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#define EVDEV_READER_LINUX
+#endif
+
+namespace
+{
+// Kernel events and window events further apart than this are not paired anymore
+constexpr auto matchWindow = sf::seconds(1.f);
+
+// Events waiting for the event thread, those which don't fit are dropped
+constexpr std::size_t maxIncoming = 4096;
+
+#ifdef EVDEV_READER_LINUX
+std::int64_t monotonicMicroseconds()
+{
+    auto now = timespec{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return std::int64_t{now.tv_sec} * 1000000 + now.tv_nsec / 1000;
+}
+
+// Keyboards and mice, the other devices such as power buttons and lid switches only report keys SFML never sees
+bool hasKeysOrButtons(int device)
+{
+    unsigned long bits[KEY_MAX / (8 * sizeof(unsigned long)) + 1]{};
+    if (ioctl(device, EVIOCGBIT(EV_KEY, sizeof(bits)), bits) == -1)
+        return false;
+
+    const auto has = [&](unsigned int code)
+    { return (bits[code / (8 * sizeof(unsigned long))] >> (code % (8 * sizeof(unsigned long)))) & 1; };
+
+    return has(KEY_A) || has(BTN_LEFT);
+}
+#endif
+
+EvdevReader::Input toVariant(std::size_t input)
+{
+    if (input < sf::Keyboard::ScancodeCount)
+        return static_cast<sf::Keyboard::Scancode>(input);
+
+    return static_cast<sf::Mouse::Button>(input - sf::Keyboard::ScancodeCount);
+}
+
+std::size_t latencyBucket(sf::Time latency, std::size_t bucketCount)
+{
+    auto bucket = std::size_t{0};
+    for (auto microseconds = latency.asMicroseconds(); 0 < microseconds && bucket + 1 < bucketCount; microseconds /= 2)
+        ++bucket;
+
+    return bucket;
+}
+
+// Upper bound in microseconds of the bucket containing the given percentile
+template <typename Histogram>
+std::string latencyPercentile(const Histogram& histogram, std::uint32_t total, std::uint32_t percent)
+{
+    auto count = std::uint32_t{0};
+    for (std::size_t bucket = 0; bucket < histogram.size(); ++bucket)
+    {
+        count += histogram[bucket];
+        if (total * std::uint64_t{percent} > count * std::uint64_t{100})
+            continue;
+
+        if (bucket + 1 == histogram.size())
+            return ">" + std::to_string(1 << (bucket - 1));
+        return "<" + std::to_string(1 << bucket);
+    }
+
+    return "-";
+}
+
+} // namespace
+
+#ifdef EVDEV_READER_LINUX
+std::optional<std::size_t> linuxCodeToInput(std::uint16_t code)
+{
+    const auto scancode = [&]() -> sf::Keyboard::Scancode
+    {
+        switch (code)
+        {
+#define CASE(code, scancode) \
+    case code:               \
+        return sf::Keyboard::Scan::scancode
+            CASE(KEY_ESC, Escape);
+            CASE(KEY_1, Num1);
+            CASE(KEY_2, Num2);
+            CASE(KEY_3, Num3);
+            CASE(KEY_4, Num4);
+            CASE(KEY_5, Num5);
+            CASE(KEY_6, Num6);
+            CASE(KEY_7, Num7);
+            CASE(KEY_8, Num8);
+            CASE(KEY_9, Num9);
+            CASE(KEY_0, Num0);
+            CASE(KEY_MINUS, Hyphen);
+            CASE(KEY_EQUAL, Equal);
+            CASE(KEY_BACKSPACE, Backspace);
+            CASE(KEY_TAB, Tab);
+            CASE(KEY_Q, Q);
+            CASE(KEY_W, W);
+            CASE(KEY_E, E);
+            CASE(KEY_R, R);
+            CASE(KEY_T, T);
+            CASE(KEY_Y, Y);
+            CASE(KEY_U, U);
+            CASE(KEY_I, I);
+            CASE(KEY_O, O);
+            CASE(KEY_P, P);
+            CASE(KEY_LEFTBRACE, LBracket);
+            CASE(KEY_RIGHTBRACE, RBracket);
+            CASE(KEY_ENTER, Enter);
+            CASE(KEY_LEFTCTRL, LControl);
+            CASE(KEY_A, A);
+            CASE(KEY_S, S);
+            CASE(KEY_D, D);
+            CASE(KEY_F, F);
+            CASE(KEY_G, G);
+            CASE(KEY_H, H);
+            CASE(KEY_J, J);
+            CASE(KEY_K, K);
+            CASE(KEY_L, L);
+            CASE(KEY_SEMICOLON, Semicolon);
+            CASE(KEY_APOSTROPHE, Apostrophe);
+            CASE(KEY_GRAVE, Grave);
+            CASE(KEY_LEFTSHIFT, LShift);
+            CASE(KEY_BACKSLASH, Backslash);
+            CASE(KEY_Z, Z);
+            CASE(KEY_X, X);
+            CASE(KEY_C, C);
+            CASE(KEY_V, V);
+            CASE(KEY_B, B);
+            CASE(KEY_N, N);
+            CASE(KEY_M, M);
+            CASE(KEY_COMMA, Comma);
+            CASE(KEY_DOT, Period);
+            CASE(KEY_SLASH, Slash);
+            CASE(KEY_RIGHTSHIFT, RShift);
+            CASE(KEY_KPASTERISK, NumpadMultiply);
+            CASE(KEY_LEFTALT, LAlt);
+            CASE(KEY_SPACE, Space);
+            CASE(KEY_CAPSLOCK, CapsLock);
+            CASE(KEY_F1, F1);
+            CASE(KEY_F2, F2);
+            CASE(KEY_F3, F3);
+            CASE(KEY_F4, F4);
+            CASE(KEY_F5, F5);
+            CASE(KEY_F6, F6);
+            CASE(KEY_F7, F7);
+            CASE(KEY_F8, F8);
+            CASE(KEY_F9, F9);
+            CASE(KEY_F10, F10);
+            CASE(KEY_NUMLOCK, NumLock);
+            CASE(KEY_SCROLLLOCK, ScrollLock);
+            CASE(KEY_KP7, Numpad7);
+            CASE(KEY_KP8, Numpad8);
+            CASE(KEY_KP9, Numpad9);
+            CASE(KEY_KPMINUS, NumpadMinus);
+            CASE(KEY_KP4, Numpad4);
+            CASE(KEY_KP5, Numpad5);
+            CASE(KEY_KP6, Numpad6);
+            CASE(KEY_KPPLUS, NumpadPlus);
+            CASE(KEY_KP1, Numpad1);
+            CASE(KEY_KP2, Numpad2);
+            CASE(KEY_KP3, Numpad3);
+            CASE(KEY_KP0, Numpad0);
+            CASE(KEY_KPDOT, NumpadDecimal);
+            CASE(KEY_102ND, NonUsBackslash);
+            CASE(KEY_F11, F11);
+            CASE(KEY_F12, F12);
+            CASE(KEY_KPENTER, NumpadEnter);
+            CASE(KEY_RIGHTCTRL, RControl);
+            CASE(KEY_KPSLASH, NumpadDivide);
+            CASE(KEY_SYSRQ, PrintScreen);
+            CASE(KEY_RIGHTALT, RAlt);
+            CASE(KEY_HOME, Home);
+            CASE(KEY_UP, Up);
+            CASE(KEY_PAGEUP, PageUp);
+            CASE(KEY_LEFT, Left);
+            CASE(KEY_RIGHT, Right);
+            CASE(KEY_END, End);
+            CASE(KEY_DOWN, Down);
+            CASE(KEY_PAGEDOWN, PageDown);
+            CASE(KEY_INSERT, Insert);
+            CASE(KEY_DELETE, Delete);
+            CASE(KEY_MUTE, VolumeMute);
+            CASE(KEY_VOLUMEDOWN, VolumeDown);
+            CASE(KEY_VOLUMEUP, VolumeUp);
+            CASE(KEY_KPEQUAL, NumpadEqual);
+            CASE(KEY_PAUSE, Pause);
+            CASE(KEY_LEFTMETA, LSystem);
+            CASE(KEY_RIGHTMETA, RSystem);
+            CASE(KEY_COMPOSE, Menu);
+            CASE(KEY_STOP, Stop);
+            CASE(KEY_AGAIN, Redo);
+            CASE(KEY_UNDO, Undo);
+            CASE(KEY_COPY, Copy);
+            CASE(KEY_PASTE, Paste);
+            CASE(KEY_FIND, Search);
+            CASE(KEY_CUT, Cut);
+            CASE(KEY_HELP, Help);
+            CASE(KEY_CALC, LaunchApplication2);
+            CASE(KEY_COMPUTER, LaunchApplication1);
+            CASE(KEY_MAIL, LaunchMail);
+            CASE(KEY_BOOKMARKS, Favorites);
+            CASE(KEY_BACK, Back);
+            CASE(KEY_FORWARD, Forward);
+            CASE(KEY_NEXTSONG, MediaNextTrack);
+            CASE(KEY_PLAYPAUSE, MediaPlayPause);
+            CASE(KEY_PREVIOUSSONG, MediaPreviousTrack);
+            CASE(KEY_STOPCD, MediaStop);
+            CASE(KEY_HOMEPAGE, HomePage);
+            CASE(KEY_REFRESH, Refresh);
+            CASE(KEY_F13, F13);
+            CASE(KEY_F14, F14);
+            CASE(KEY_F15, F15);
+            CASE(KEY_F16, F16);
+            CASE(KEY_F17, F17);
+            CASE(KEY_F18, F18);
+            CASE(KEY_F19, F19);
+            CASE(KEY_F20, F20);
+            CASE(KEY_F21, F21);
+            CASE(KEY_F22, F22);
+            CASE(KEY_F23, F23);
+            CASE(KEY_F24, F24);
+            CASE(KEY_SEARCH, Search);
+            CASE(KEY_MEDIA, LaunchMediaSelect);
+            CASE(KEY_SELECT, Select);
+#undef CASE
+            default:
+                return sf::Keyboard::Scan::Unknown;
+        }
+    }();
+    if (scancode != sf::Keyboard::Scan::Unknown)
+        return static_cast<std::size_t>(scancode);
+
+    const auto button = [&]() -> std::optional<sf::Mouse::Button>
+    {
+        switch (code)
+        {
+            case BTN_LEFT:
+                return sf::Mouse::Button::Left;
+            case BTN_RIGHT:
+                return sf::Mouse::Button::Right;
+            case BTN_MIDDLE:
+                return sf::Mouse::Button::Middle;
+            case BTN_SIDE:
+                return sf::Mouse::Button::Extra1;
+            case BTN_EXTRA:
+                return sf::Mouse::Button::Extra2;
+            default:
+                return std::nullopt;
+        }
+    }();
+    if (button)
+        return sf::Keyboard::ScancodeCount + static_cast<std::size_t>(*button);
+
+    return std::nullopt;
+}
+#endif
+
+EvdevReader::EvdevReader(const sf::Clock&             clock,
+                         const std::filesystem::path& replayPath,
+                         const std::filesystem::path& recordPath) :
+m_clock{clock}
+{
+    m_incoming.reserve(maxIncoming);
+    m_received.reserve(maxIncoming);
+    m_kernelPending.reserve(maxIncoming);
+    m_eventPending.reserve(maxIncoming);
+    m_latencies.reserve(maxIncoming);
+
+#ifdef EVDEV_READER_LINUX
+    if (!replayPath.empty())
+    {
+        auto file = std::ifstream{replayPath};
+        if (!file)
+        {
+            std::cout << "Error: cannot open evdev recording " << replayPath.string() << '\n';
+            return;
+        }
+
+        // One event per line, MICROSECONDS CODE VALUE, comments start with #
+        auto line = std::string{};
+        for (auto number = 1; std::getline(file, line); ++number)
+        {
+            if (line.empty() || line.front() == '#')
+                continue;
+
+            auto stream       = std::istringstream{line};
+            auto microseconds = std::int64_t{};
+            auto code = 0u, value = 0u;
+            if (!(stream >> microseconds >> code >> value) || value > 1)
+            {
+                std::cout << "Error: invalid evdev event on line " << number << " of " << replayPath.string() << '\n';
+                m_replayed.clear();
+                return;
+            }
+
+            if (const auto input = linuxCodeToInput(static_cast<std::uint16_t>(code)))
+                m_replayed.push_back({*input, value == 1, sf::microseconds(microseconds)});
+        }
+
+        if (m_replayed.empty())
+        {
+            std::cout << "Error: no key or button event in " << replayPath.string() << '\n';
+            return;
+        }
+
+        m_thread = std::thread{&EvdevReader::replay, this};
+        return;
+    }
+
+    // Both clocks are monotonic, only their origins differ
+    m_clockOffset = monotonicMicroseconds() - m_clock.getElapsedTime().asMicroseconds();
+
+    m_epoll  = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_epoll == -1 || m_wakeup == -1)
+    {
+        std::cout << "Error: cannot wait for input devices: " << std::strerror(errno) << '\n';
+        return;
+    }
+
+    auto wakeup    = epoll_event{};
+    wakeup.events  = EPOLLIN;
+    wakeup.data.fd = m_wakeup;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &wakeup);
+
+    auto denied = 0;
+    auto error  = std::error_code{};
+    for (const auto& entry : std::filesystem::directory_iterator{"/dev/input", error})
+    {
+        if (entry.path().filename().string().rfind("event", 0) != 0)
+            continue;
+
+        const auto device = open(entry.path().c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (device == -1)
+        {
+            denied += errno == EACCES;
+            continue;
+        }
+
+        // Timestamps on the clock of the session rather than the wall clock, which may jump
+        const int clockId = CLOCK_MONOTONIC;
+        auto      ready   = epoll_event{};
+        ready.events      = EPOLLIN;
+        ready.data.fd     = device;
+        if (!hasKeysOrButtons(device) || ioctl(device, EVIOCSCLOCKID, &clockId) == -1 ||
+            epoll_ctl(m_epoll, EPOLL_CTL_ADD, device, &ready) == -1)
+        {
+            close(device);
+            continue;
+        }
+
+        m_devices.push_back(device);
+    }
+
+    if (m_devices.empty())
+    {
+        std::cout << "Error: no keyboard or mouse readable in /dev/input";
+        if (denied != 0)
+            std::cout << ", " << denied << " devices need the permissions of the input group";
+        std::cout << '\n';
+        return;
+    }
+
+    if (!recordPath.empty())
+    {
+        if (m_record.open(recordPath); m_record)
+            m_record << "# evdev key and button events: microseconds since the start of the session, code, value\n";
+        else
+            std::cout << "Error: cannot open evdev recording " << recordPath.string() << '\n';
+    }
+
+    m_thread = std::thread{&EvdevReader::read, this};
+#else
+    static_cast<void>(replayPath);
+    static_cast<void>(recordPath);
+    std::cout << "Error: reading input devices is only supported on Linux\n";
+#endif
+}
+
+EvdevReader::~EvdevReader()
+{
+    m_running = false;
+
+#ifdef EVDEV_READER_LINUX
+    if (m_wakeup != -1)
+    {
+        const auto one = std::uint64_t{1};
+        static_cast<void>(write(m_wakeup, &one, sizeof(one)));
+    }
+#endif
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+#ifdef EVDEV_READER_LINUX
+    for (const auto device : m_devices)
+        close(device);
+    if (m_wakeup != -1)
+        close(m_wakeup);
+    if (m_epoll != -1)
+        close(m_epoll);
+#endif
+}
+
+bool EvdevReader::isOpen() const
+{
+    return m_thread.joinable();
+}
+
+void EvdevReader::handle(const sf::Event& event, sf::Time timestamp)
+{
+    auto add = [&](std::size_t input, bool pressed)
+    {
+        // Autorepeat has no kernel event of its own, evdev repeats are ignored as well
+        if (pressed && m_held[input])
+            return;
+        m_held[input] = pressed;
+
+        if (m_eventPending.size() < maxIncoming)
+            m_eventPending.push_back({input, pressed, timestamp});
+    };
+
+    if (event.is<sf::Event::FocusLost>())
+    {
+        // The kernel keeps reporting what goes to other windows
+        m_focused = false;
+        m_held    = {};
+    }
+    else if (event.is<sf::Event::FocusGained>())
+    {
+        m_focused      = true;
+        m_focusedSince = timestamp;
+    }
+    else if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>())
+    {
+        if (keyPressed->scancode != sf::Keyboard::Scan::Unknown)
+            add(static_cast<std::size_t>(keyPressed->scancode), true);
+    }
+    else if (const auto* keyReleased = event.getIf<sf::Event::KeyReleased>())
+    {
+        if (keyReleased->scancode != sf::Keyboard::Scan::Unknown)
+            add(static_cast<std::size_t>(keyReleased->scancode), false);
+    }
+    else if (const auto* buttonPressed = event.getIf<sf::Event::MouseButtonPressed>())
+    {
+        add(sf::Keyboard::ScancodeCount + static_cast<std::size_t>(buttonPressed->button), true);
+    }
+    else if (const auto* buttonReleased = event.getIf<sf::Event::MouseButtonReleased>())
+    {
+        add(sf::Keyboard::ScancodeCount + static_cast<std::size_t>(buttonReleased->button), false);
+    }
+}
+
+const std::vector<EvdevReader::Latency>& EvdevReader::correlate(sf::Time now)
+{
+    m_latencies.clear();
+
+    {
+        // Swapping keeps the capacity of both vectors, so neither thread allocates
+        const auto lock = std::lock_guard{m_mutex};
+        m_received.swap(m_incoming);
+    }
+    for (const auto& event : m_received)
+        if (m_kernelPending.size() < maxIncoming)
+            m_kernelPending.push_back(event);
+    m_received.clear();
+
+    // Each window event takes the oldest kernel event of the same input and direction
+    for (auto event = m_eventPending.begin(); event != m_eventPending.end();)
+    {
+        const auto kernel = std::find_if(m_kernelPending.begin(),
+                                         m_kernelPending.end(),
+                                         [&](const KernelEvent& kernelEvent)
+                                         {
+                                             return kernelEvent.input == event->input &&
+                                                    kernelEvent.pressed == event->pressed &&
+                                                    event->timestamp - kernelEvent.timestamp < matchWindow;
+                                         });
+        if (kernel == m_kernelPending.end())
+        {
+            ++event;
+            continue;
+        }
+
+        m_latencies.push_back({toVariant(event->input), event->pressed, kernel->timestamp, event->timestamp});
+        addLatency(event->timestamp - kernel->timestamp);
+        m_kernelPending.erase(kernel);
+        event = m_eventPending.erase(event);
+    }
+
+    // What is left once the other side had time enough to arrive was only seen by one side
+    const auto expired = [&](const KernelEvent& event) { return now - event.timestamp > matchWindow; };
+    for (const auto& event : m_kernelPending)
+    {
+        if (!expired(event))
+            continue;
+
+        if (m_focused && m_focusedSince <= event.timestamp)
+            ++m_kernelOnly;
+        else
+            ++m_unfocused;
+    }
+    m_kernelPending.erase(std::remove_if(m_kernelPending.begin(), m_kernelPending.end(), expired),
+                          m_kernelPending.end());
+
+    m_eventOnly += static_cast<std::uint32_t>(std::count_if(m_eventPending.begin(), m_eventPending.end(), expired));
+    m_eventPending.erase(std::remove_if(m_eventPending.begin(), m_eventPending.end(), expired), m_eventPending.end());
+
+    return m_latencies;
+}
+
+void EvdevReader::print(std::ostream& os) const
+{
+    os << "\tLatency of the display server and window queue, from the kernel timestamp to the window event\n\n";
+    if (m_count == 0)
+    {
+        os << "No event was seen by both\n";
+    }
+    else
+    {
+        os << "Events: " << m_count << ", " << m_min.asMicroseconds() << " us at least, "
+           << m_sum.asMicroseconds() / m_count << " us on average, " << m_max.asMicroseconds() << " us at most\n";
+        os << "Percentiles in us: 50th " << latencyPercentile(m_histogram, m_count, 50) << ", 90th "
+           << latencyPercentile(m_histogram, m_count, 90) << ", 99th " << latencyPercentile(m_histogram, m_count, 99)
+           << '\n';
+    }
+
+    const auto overflows = [&]
+    {
+        const auto lock = std::lock_guard{m_mutex};
+        return m_overflows;
+    }();
+    os << "Kernel events without window event: " << m_kernelOnly << ", " << m_unfocused
+       << " more while another window had the focus\n";
+    os << "Window events without kernel event: " << m_eventOnly << '\n';
+    os << "Kernel buffer overflows: " << m_syncDropped << ", events dropped by the reader: " << overflows << "\n\n";
+}
+
+void EvdevReader::read()
+{
+#ifdef EVDEV_READER_LINUX
+    epoll_event ready[16];
+    input_event events[64];
+    while (m_running)
+    {
+        const auto readyCount = epoll_wait(m_epoll, ready, 16, -1);
+        if (readyCount == -1 && errno != EINTR)
+        {
+            std::cout << "Error: cannot wait for input devices: " << std::strerror(errno) << '\n';
+            return;
+        }
+
+        for (auto i = 0; i < readyCount; ++i)
+        {
+            const auto device = ready[i].data.fd;
+            if (device == m_wakeup)
+                return;
+
+            auto bytes = ssize_t{0};
+            while ((bytes = ::read(device, events, sizeof(events))) > 0)
+            {
+                for (auto event = events; event < events + bytes / static_cast<ssize_t>(sizeof(input_event)); ++event)
+                {
+                    if (event->type == EV_SYN && event->code == SYN_DROPPED)
+                        ++m_syncDropped;
+
+                    // Value 2 is autorepeat
+                    if (event->type != EV_KEY || event->value > 1)
+                        continue;
+
+                    const auto microseconds = std::int64_t{event->input_event_sec} * 1000000 + event->input_event_usec -
+                                              m_clockOffset;
+                    if (m_record.is_open())
+                        m_record << microseconds << ' ' << event->code << ' ' << event->value << '\n';
+
+                    if (const auto input = linuxCodeToInput(event->code))
+                        receive({*input, event->value == 1, sf::microseconds(microseconds)});
+                }
+            }
+
+            // The device was unplugged
+            if (bytes == -1 && errno == ENODEV)
+            {
+                epoll_ctl(m_epoll, EPOLL_CTL_DEL, device, nullptr);
+                close(device);
+                m_devices.erase(std::find(m_devices.begin(), m_devices.end(), device));
+            }
+        }
+    }
+#endif
+}
+
+void EvdevReader::replay()
+{
+    // The recording is played from now on, as if the devices sent it again
+    const auto start  = m_clock.getElapsedTime();
+    const auto origin = m_replayed.front().timestamp;
+    for (auto event : m_replayed)
+    {
+        event.timestamp = start + (event.timestamp - origin);
+        for (auto now = m_clock.getElapsedTime(); now < event.timestamp; now = m_clock.getElapsedTime())
+        {
+            if (!m_running)
+                return;
+            sf::sleep(std::min(event.timestamp - now, sf::milliseconds(10)));
+        }
+
+        receive(event);
+    }
+}
+
+void EvdevReader::receive(const KernelEvent& event)
+{
+    const auto lock = std::lock_guard{m_mutex};
+    if (m_incoming.size() < maxIncoming)
+        m_incoming.push_back(event);
+    else
+        ++m_overflows;
+}
+
+void EvdevReader::addLatency(sf::Time latency)
+{
+    m_min = m_count == 0 ? latency : std::min(m_min, latency);
+    m_max = m_count == 0 ? latency : std::max(m_max, latency);
+    m_sum += latency;
+    ++m_count;
+    ++m_histogram[latencyBucket(latency, latencyBucketCount)];
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Keyboard.hpp>
+#include <SFML/Window/Mouse.hpp>
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include <cstdint>
+
+// Reads the key and button events of /dev/input/event* on a background thread, as the kernel timestamped them, and
+// pairs them with the window events to measure how long the display server and the window queue took to deliver
+// them. Linux only, reading the devices usually requires membership in the input group.
+class EvdevReader
+{
+public:
+    using Input = std::variant<sf::Keyboard::Scancode, sf::Mouse::Button>;
+
+    struct Latency
+    {
+        Input    input;
+        bool     pressed;
+        sf::Time kernelTime; // when the kernel received the event, in session time
+        sf::Time eventTime;  // when the window event was polled
+    };
+
+    // Replays the recording at replayPath instead of reading the devices if not empty, and writes the kernel events
+    // to recordPath if not empty, in the format replayed
+    EvdevReader(const sf::Clock&             clock,
+                const std::filesystem::path& replayPath,
+                const std::filesystem::path& recordPath);
+    ~EvdevReader();
+
+    EvdevReader(const EvdevReader&)            = delete;
+    EvdevReader& operator=(const EvdevReader&) = delete;
+
+    bool isOpen() const;
+
+    void handle(const sf::Event& event, sf::Time timestamp);
+
+    // Pairs what arrived from both sides, the results are valid until the next call
+    const std::vector<Latency>& correlate(sf::Time now);
+
+    // Latency distribution and the events only one side saw
+    void print(std::ostream& os) const;
+
+private:
+    struct KernelEvent
+    {
+        std::size_t input; // scancode, or sf::Keyboard::ScancodeCount + button
+        bool        pressed;
+        sf::Time    timestamp;
+    };
+
+    void read();
+    void replay();
+    void receive(const KernelEvent& event);
+    void addLatency(sf::Time latency);
+
+    static constexpr auto inputCount = sf::Keyboard::ScancodeCount + sf::Mouse::ButtonCount;
+
+    // Bucket 0 counts latencies shorter than 1 us, bucket i those between 2^(i-1) and 2^i us and the last bucket
+    // everything longer
+    static constexpr std::size_t latencyBucketCount = 18;
+
+    const sf::Clock& m_clock;
+    bool             m_focused = true;
+    sf::Time         m_focusedSince;
+
+    // Of the reading thread
+    std::int64_t             m_clockOffset = 0; // CLOCK_MONOTONIC minus session time, in microseconds
+    std::vector<int>         m_devices;
+    int                      m_epoll  = -1;
+    int                      m_wakeup = -1; // written to stop the thread
+    std::vector<KernelEvent> m_replayed;
+    std::ofstream            m_record;
+    std::atomic<bool>        m_running{true};
+    std::thread              m_thread;
+
+    // Handed from the reading thread to the event thread
+    mutable std::mutex         m_mutex;
+    std::vector<KernelEvent>   m_incoming;
+    std::uint64_t              m_overflows = 0;  // events which didn't fit into m_incoming
+    std::atomic<std::uint64_t> m_syncDropped{0}; // times the kernel buffer of a device overflowed
+
+    // Of the event thread
+    std::vector<KernelEvent>     m_received;
+    std::vector<KernelEvent>     m_kernelPending;
+    std::vector<KernelEvent>     m_eventPending;
+    std::array<bool, inputCount> m_held{}; // to tell autorepeat apart
+    std::vector<Latency>         m_latencies;
+
+    std::array<std::uint32_t, latencyBucketCount> m_histogram{};
+    std::uint32_t                                 m_count = 0;
+    sf::Time                                      m_sum, m_min, m_max;
+    std::uint32_t                                 m_kernelOnly = 0, m_unfocused = 0, m_eventOnly = 0;
+};
+
+// Scancode, or sf::Keyboard::ScancodeCount + button, of a Linux input event code. Linux only, the X11 keycodes used
+// by SFML are these codes plus 8.
+std::optional<std::size_t> linuxCodeToInput(std::uint16_t code);
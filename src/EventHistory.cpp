@@ -0,0 +1,230 @@
+#include "EventHistory.hpp"
+
+#include "TextBuilder.hpp"
+#include "strings.hpp"
+
+#include <algorithm>
+
+namespace
+{
+constexpr auto textSize     = 14u;
+constexpr auto rowsPerNotch = 3.f;
+
+TextBuilder describe(FrameArena& arena, const EventRecord& record)
+{
+    static constexpr const char* types[] = {
+        "Key Pressed",
+        "Key Released",
+        "Text Entered",
+        "Button Pressed",
+        "Button Released",
+        "Text Missing",
+        "Stuck Press",
+        "Missing Release",
+        "Release Without Press",
+        "Release Lost",
+    };
+    static constexpr const char* flags[] = {"Strange", "Chatter", "Composed", "Without Press"};
+
+    auto text = TextBuilder{arena};
+    text += record.timestamp / 1000;
+    text += " ms\t";
+    text += types[static_cast<int>(record.type)];
+    text += "\t";
+
+    switch (record.type)
+    {
+        case EventRecord::Type::KeyPressed:
+        case EventRecord::Type::KeyReleased:
+            text += "sf::Keyboard::";
+            text += scancodeIdentifier(static_cast<sf::Keyboard::Scancode>(record.scancode));
+            text += "\tsf::Keyboard::";
+            text += keyIdentifier(static_cast<sf::Keyboard::Key>(record.code));
+            break;
+        case EventRecord::Type::MissingText:
+            text += "sf::Keyboard::";
+            text += scancodeIdentifier(static_cast<sf::Keyboard::Scancode>(record.scancode));
+            break;
+        case EventRecord::Type::TextEntered:
+            text += record.unicode;
+            if (record.unicode >= 32 && record.unicode != 127) // control characters would break the row
+            {
+                text += " ";
+                text += static_cast<char32_t>(record.unicode);
+            }
+            break;
+        case EventRecord::Type::MouseButtonPressed:
+        case EventRecord::Type::MouseButtonReleased:
+            text += "sf::Mouse::";
+            text += buttonIdentifier(static_cast<sf::Mouse::Button>(record.code));
+            break;
+        case EventRecord::Type::StuckPress:
+        case EventRecord::Type::MissingRelease:
+        case EventRecord::Type::ReleaseWithoutPress:
+        case EventRecord::Type::LostRelease:
+            if (record.scancode >= 0)
+            {
+                text += "sf::Keyboard::";
+                text += scancodeIdentifier(static_cast<sf::Keyboard::Scancode>(record.scancode));
+            }
+            else
+            {
+                text += "sf::Mouse::";
+                text += buttonIdentifier(static_cast<sf::Mouse::Button>(record.code));
+            }
+            break;
+    }
+
+    for (std::size_t bit = 0; bit < std::size(flags); ++bit)
+        if (record.flags & (1 << bit))
+        {
+            text += "\t";
+            text += flags[bit];
+        }
+
+    return text;
+}
+
+sf::Color color(const EventRecord& record)
+{
+    if (record.flags & EventRecord::Synthetic)
+        return sf::Color{128, 128, 128};
+    if (record.type >= EventRecord::Type::MissingText ||
+        record.flags & (EventRecord::Strange | EventRecord::TextWithoutPress))
+        return sf::Color::Red;
+    if (record.flags & EventRecord::Chatter)
+        return sf::Color::Magenta;
+    if (record.flags & EventRecord::Composed)
+        return sf::Color::Yellow;
+
+    return sf::Color::White;
+}
+
+} // namespace
+
+EventHistory::EventHistory(FrameArena& arena) : m_arena{arena}, m_records(capacity)
+{
+}
+
+void EventHistory::push(const EventRecord& record)
+{
+    m_records[m_count++ % capacity] = record;
+}
+
+void EventHistory::handle(const sf::Event& event)
+{
+    const auto* wheelScrolled = event.getIf<sf::Event::MouseWheelScrolled>();
+    if (!wheelScrolled || wheelScrolled->wheel != sf::Mouse::Wheel::Vertical || m_count == 0)
+        return;
+
+    const auto position = getInverseTransform().transformPoint(sf::Vector2f{wheelScrolled->position});
+    if (position.x < 0.f || position.y < 0.f || position.x > size.x || position.y > size.y)
+        return;
+
+    // Scrolling up shows older records, it does nothing while all of them fit
+    const auto newest = static_cast<std::int64_t>(m_newestVisible.value_or(m_count - 1)) -
+                        static_cast<std::int64_t>(wheelScrolled->delta * rowsPerNotch);
+    const auto oldest = static_cast<std::int64_t>(std::min(oldestIndex() + visibleRows - 1, m_count - 1));
+
+    if (std::max(newest, oldest) >= static_cast<std::int64_t>(m_count - 1))
+        m_newestVisible.reset();
+    else
+        m_newestVisible = static_cast<std::uint64_t>(std::max(newest, oldest));
+}
+
+void EventHistory::update(State& state)
+{
+    // Records scrolled to may have been overwritten in the meantime
+    if (m_newestVisible && *m_newestVisible < oldestIndex() + visibleRows - 1)
+        m_newestVisible = std::min(oldestIndex() + visibleRows - 1, m_count - 1);
+
+    state.transform = getTransform();
+    state.last      = m_newestVisible ? *m_newestVisible + 1 : m_count;
+    state.first     = std::max(oldestIndex(), state.last - std::min<std::uint64_t>(state.last, visibleRows));
+
+    for (auto index = state.first; index < state.last; ++index)
+    {
+        auto& row = state.rows[index % visibleRows];
+        if (row.index != index)
+        {
+            const auto& record = m_records[index % capacity];
+            describe(m_arena, record).copyTo(row.text);
+            row.color = color(record);
+            row.index = index;
+        }
+    }
+
+    if (m_titleCount != m_count || m_titleLast != state.last)
+    {
+        auto title = TextBuilder{m_arena};
+        title += "Event History\t";
+        title += m_count;
+        title += " events";
+        if (m_newestVisible)
+        {
+            title += "\tscrolled ";
+            title += m_count - state.last;
+            title += " back, scroll down to follow";
+        }
+        title.copyTo(state.title);
+        m_titleCount = m_count;
+        m_titleLast  = state.last;
+    }
+}
+
+std::uint64_t EventHistory::oldestIndex() const
+{
+    return m_count > capacity ? m_count - capacity : 0;
+}
+
+EventHistoryView::EventHistoryView(const sf::Font& font) : m_content{font}
+{
+}
+
+void EventHistoryView::apply(const EventHistory::State& state)
+{
+    auto& content = m_content;
+    auto  changed = setText(content.title, state.title);
+    changed |= content.first != state.first || content.last != state.last;
+
+    m_transform   = state.transform;
+    content.first = state.first;
+    content.last  = state.last;
+
+    // Newest on top, rows which only moved keep their layout
+    for (auto index = content.first; index < content.last; ++index)
+    {
+        const auto& from = state.rows[index % EventHistory::visibleRows];
+        auto&       row  = content.rows[index % EventHistory::visibleRows];
+        if (row.index != index)
+        {
+            setText(row.text, from.text);
+            row.text.setFillColor(from.color);
+            row.index = index;
+            changed   = true;
+        }
+        row.text.setPosition({0.f, static_cast<float>(content.last - index + 1) * EventHistory::rowHeight});
+    }
+
+    m_revision += changed;
+}
+
+void EventHistoryView::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    states.transform *= m_transform;
+    m_cache.draw(target, states, m_content, m_revision);
+}
+
+EventHistoryView::Content::Content(const sf::Font& font) : title{font, "", textSize}
+{
+    rows.reserve(EventHistory::visibleRows);
+    for (std::size_t i = 0; i < EventHistory::visibleRows; ++i)
+        rows.push_back({sf::Text{font, "", textSize}});
+}
+
+void EventHistoryView::Content::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    target.draw(title, states);
+    for (auto index = first; index < last; ++index)
+        target.draw(rows[index % EventHistory::visibleRows].text, states);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "EventRecord.hpp"
+#include "FrameArena.hpp"
+#include "LayerCache.hpp"
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Transformable.hpp>
+
+#include <SFML/Window/Event.hpp>
+
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <cstdint>
+
+// Scrollable list of the last events, rows are only described when a new record scrolls into view
+class EventHistory : public sf::Transformable
+{
+public:
+    static constexpr std::size_t visibleRows = 22;
+    static constexpr auto        rowHeight   = 18.f;
+    static constexpr auto        size        = sf::Vector2f{940.f, (visibleRows + 2) * rowHeight};
+
+    struct Row
+    {
+        std::u32string text;
+        sf::Color      color;
+        std::uint64_t  index = ~std::uint64_t{0}; // of the record shown, rows are reused by index % visibleRows
+    };
+
+    // What the view draws
+    struct State
+    {
+        sf::Transform                transform;
+        std::u32string               title;
+        std::array<Row, visibleRows> rows;
+        std::uint64_t                first = 0, last = 0; // visible range of indices, last excluded
+    };
+
+    explicit EventHistory(FrameArena& arena);
+
+    void push(const EventRecord& record);
+
+    // Scrolls with the mouse wheel over the panel, keys are left alone since they are what is being tested
+    void handle(const sf::Event& event);
+
+    // The state is expected to be the one of the last call, its rows which still show the same record are kept
+    void update(State& state);
+
+private:
+    static constexpr std::size_t capacity = 65536; // 2 MiB of records
+
+    std::uint64_t oldestIndex() const;
+
+    FrameArena&                  m_arena;
+    std::vector<EventRecord>     m_records; // ring indexed by index % capacity
+    std::uint64_t                m_count = 0;
+    std::optional<std::uint64_t> m_newestVisible; // follows the newest record if empty
+    std::uint64_t                m_titleCount = ~std::uint64_t{0}, m_titleLast = 0; // shown in the title
+};
+
+// Draws the state of an event history, rows are only laid out again when they show another record and the texts are
+// only drawn again when any of them changed
+class EventHistoryView : public sf::Drawable
+{
+public:
+    explicit EventHistoryView(const sf::Font& font);
+
+    void apply(const EventHistory::State& state);
+
+private:
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    struct Row
+    {
+        sf::Text      text;
+        std::uint64_t index = ~std::uint64_t{0};
+    };
+
+    // Everything but the transform, which places the cached texture
+    struct Content : sf::Drawable
+    {
+        explicit Content(const sf::Font& font);
+
+        void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+        sf::Text         title;
+        std::vector<Row> rows;
+        std::uint64_t    first = 0, last = 0;
+    };
+
+    sf::Transform      m_transform;
+    Content            m_content;
+    std::uint32_t      m_revision = 0;
+    mutable LayerCache m_cache{{{}, EventHistory::size}};
+};
@@ -0,0 +1,164 @@
+#include "EventRecord.hpp"
+
+#include "strings.hpp"
+
+namespace
+{
+template <typename KeyEventType>
+EventRecord makeKeyRecord(EventRecord::Type type, const KeyEventType& keyEvent, sf::Time timestamp)
+{
+    auto record        = EventRecord{};
+    record.timestamp   = timestamp.asMicroseconds();
+    record.type        = type;
+    record.code        = static_cast<std::int16_t>(keyEvent.code);
+    record.scancode    = static_cast<std::int16_t>(keyEvent.scancode);
+    record.localized   = static_cast<std::int16_t>(sf::Keyboard::localize(keyEvent.scancode));
+    record.delocalized = static_cast<std::int16_t>(sf::Keyboard::delocalize(keyEvent.code));
+
+    if (keyEvent.code == sf::Keyboard::Key::Unknown || keyEvent.scancode == sf::Keyboard::Scan::Unknown ||
+        sf::Keyboard::getDescription(keyEvent.scancode) == "" || record.localized != record.code ||
+        record.delocalized != record.scancode)
+        record.flags |= EventRecord::Strange;
+
+    return record;
+}
+
+EventRecord makeButtonRecord(EventRecord::Type type, sf::Mouse::Button button, sf::Time timestamp)
+{
+    auto record      = EventRecord{};
+    record.timestamp = timestamp.asMicroseconds();
+    record.type      = type;
+    record.code      = static_cast<std::int16_t>(button);
+
+    return record;
+}
+
+std::string key(std::int16_t code)
+{
+    return '"' + std::string{keyIdentifier(static_cast<sf::Keyboard::Key>(code))} + '"';
+}
+
+std::string scancode(std::int16_t scancode)
+{
+    return '"' + std::string{scancodeIdentifier(static_cast<sf::Keyboard::Scancode>(scancode))} + '"';
+}
+
+std::string button(std::int16_t button)
+{
+    return '"' + std::string{buttonIdentifier(static_cast<sf::Mouse::Button>(button))} + '"';
+}
+
+} // namespace
+
+std::optional<EventRecord> makeRecord(const sf::Event& event, sf::Time timestamp)
+{
+    if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>())
+        return makeKeyRecord(EventRecord::Type::KeyPressed, *keyPressed, timestamp);
+
+    if (const auto* keyReleased = event.getIf<sf::Event::KeyReleased>())
+        return makeKeyRecord(EventRecord::Type::KeyReleased, *keyReleased, timestamp);
+
+    if (const auto* textEntered = event.getIf<sf::Event::TextEntered>())
+    {
+        auto record      = EventRecord{};
+        record.timestamp = timestamp.asMicroseconds();
+        record.type      = EventRecord::Type::TextEntered;
+        record.unicode   = static_cast<std::uint32_t>(textEntered->unicode);
+
+        return record;
+    }
+
+    if (const auto* buttonPressed = event.getIf<sf::Event::MouseButtonPressed>())
+        return makeButtonRecord(EventRecord::Type::MouseButtonPressed, buttonPressed->button, timestamp);
+
+    if (const auto* buttonReleased = event.getIf<sf::Event::MouseButtonReleased>())
+        return makeButtonRecord(EventRecord::Type::MouseButtonReleased, buttonReleased->button, timestamp);
+
+    return std::nullopt;
+}
+
+const char* typeName(EventRecord::Type type)
+{
+    static constexpr const char* types[EventRecord::typeCount] = {
+        "KeyPressed",
+        "KeyReleased",
+        "TextEntered",
+        "MouseButtonPressed",
+        "MouseButtonReleased",
+        "MissingText",
+        "StuckPress",
+        "MissingRelease",
+        "ReleaseWithoutPress",
+        "LostRelease",
+    };
+
+    return types[static_cast<std::size_t>(type)];
+}
+
+const char* flagName(std::size_t bit)
+{
+    static constexpr const char* flags[EventRecord::flagCount] =
+        {"Strange", "Chatter", "Composed", "TextWithoutPress", "Synthetic"};
+
+    return flags[bit];
+}
+
+std::string format(const EventRecord& record)
+{
+    auto line = std::string{"{\"time\":"};
+    line += std::to_string(record.timestamp);
+    line += ",\"type\":\"";
+    line += typeName(record.type);
+    line += '"';
+
+    switch (record.type)
+    {
+        case EventRecord::Type::KeyPressed:
+        case EventRecord::Type::KeyReleased:
+        case EventRecord::Type::MissingText:
+            line += ",\"code\":" + key(record.code);
+            line += ",\"scancode\":" + scancode(record.scancode);
+            line += ",\"localized\":" + key(record.localized);
+            line += ",\"delocalized\":" + scancode(record.delocalized);
+            break;
+        case EventRecord::Type::TextEntered:
+            line += ",\"unicode\":" + std::to_string(record.unicode);
+            line += ",\"scancode\":" + scancode(record.scancode);
+            line += ",\"latency\":" + std::to_string(record.latency);
+            break;
+        case EventRecord::Type::MouseButtonPressed:
+        case EventRecord::Type::MouseButtonReleased:
+            line += ",\"button\":" + button(record.code);
+            break;
+        case EventRecord::Type::StuckPress:
+        case EventRecord::Type::MissingRelease:
+        case EventRecord::Type::ReleaseWithoutPress:
+        case EventRecord::Type::LostRelease:
+            if (record.scancode >= 0)
+                line += ",\"scancode\":" + scancode(record.scancode);
+            else
+                line += ",\"button\":" + button(record.code);
+            break;
+    }
+
+    if (record.flags != 0)
+    {
+        line += ",\"flags\":[";
+        auto separator = "";
+        for (std::size_t bit = 0; bit < EventRecord::flagCount; ++bit)
+        {
+            if ((record.flags & (1 << bit)) == 0)
+                continue;
+
+            line += separator;
+            line += '"';
+            line += flagName(bit);
+            line += '"';
+            separator = ",";
+        }
+        line += ']';
+    }
+    line += "}\n";
+
+    return line;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <SFML/Window/Event.hpp>
+
+#include <SFML/System/Time.hpp>
+
+#include <optional>
+#include <string>
+
+#include <cstdint>
+
+// Compact and trivially copyable description of an input event, used for the structured log
+struct EventRecord
+{
+    enum class Type : std::uint8_t
+    {
+        KeyPressed,
+        KeyReleased,
+        TextEntered,
+        MouseButtonPressed,
+        MouseButtonReleased,
+        MissingText,         // a key press which should have produced text but didn't
+        StuckPress,          // key or button held for a suspiciously long time
+        MissingRelease,      // key or button released without a release event
+        ReleaseWithoutPress, // release event for a key or button which was not pressed
+        LostRelease,         // key or button released while another window had the focus
+    };
+
+    enum Flag : std::uint16_t
+    {
+        Strange          = 1 << 0, // code, scancode, localize and delocalize don't agree
+        Chatter          = 1 << 1, // press right after the release of the same key
+        Composed         = 1 << 2, // text produced by several presses, e.g. dead keys or compose sequences
+        TextWithoutPress = 1 << 3, // text which no key press can explain, e.g. from an IME
+        Synthetic        = 1 << 4, // typed by the soak mode, not checked
+    };
+
+    static constexpr std::size_t typeCount = 10;
+    static constexpr std::size_t flagCount = 5;
+
+    std::int64_t  timestamp   = 0; // microseconds since the start of the session
+    Type          type        = Type::KeyPressed;
+    std::uint16_t flags       = 0;
+    std::int16_t  code        = -1; // sf::Keyboard::Key or sf::Mouse::Button, watchdog findings only set the button
+    std::int16_t  scancode    = -1; // for text, the scancode of the press which produced it
+    std::int16_t  localized   = -1;
+    std::int16_t  delocalized = -1;
+    std::uint32_t unicode     = 0;
+    std::int32_t  latency     = 0; // microseconds between a key press and its text
+};
+
+// Only key, text and mouse button events are recorded
+std::optional<EventRecord> makeRecord(const sf::Event& event, sf::Time timestamp);
+
+// Names used in the JSON lines
+const char* typeName(EventRecord::Type type);
+const char* flagName(std::size_t bit);
+
+// One line of JSON
+std::string format(const EventRecord& record);
@@ -0,0 +1,210 @@
+#include "EventServer.hpp"
+
+#include <iostream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#define EVENT_SERVER_POSIX
+#endif
+
+namespace
+{
+// A client which falls further behind loses records rather than delaying the others
+constexpr std::size_t maxPending = 64 * 1024;
+
+constexpr std::size_t maxClients = 16;
+
+#ifdef EVENT_SERVER_POSIX
+#ifdef MSG_NOSIGNAL
+constexpr int sendFlags = MSG_NOSIGNAL | MSG_DONTWAIT;
+#else
+constexpr int sendFlags = MSG_DONTWAIT; // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+bool setNonBlocking(int socket)
+{
+    const auto flags = fcntl(socket, F_GETFL);
+    return flags != -1 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+// Only a socket nobody listens on anymore is left over from an earlier run and removed, anything else is kept
+bool removeStaleSocket(const sockaddr_un& address)
+{
+    struct stat status;
+    if (lstat(address.sun_path, &status) == -1)
+    {
+        if (errno == ENOENT)
+            return true;
+
+        std::cout << "Error: cannot check socket " << address.sun_path << ": " << std::strerror(errno) << '\n';
+        return false;
+    }
+
+    if (!S_ISSOCK(status.st_mode))
+    {
+        std::cout << "Error: " << address.sun_path << " exists and is not a socket\n";
+        return false;
+    }
+
+    const auto probe     = socket(AF_UNIX, SOCK_STREAM, 0);
+    const auto* target   = reinterpret_cast<const sockaddr*>(&address);
+    const auto listening = probe != -1 && connect(probe, target, sizeof(address)) == 0;
+    if (probe != -1)
+        close(probe);
+    if (listening)
+    {
+        std::cout << "Error: socket " << address.sun_path << " is in use\n";
+        return false;
+    }
+
+    if (unlink(address.sun_path) == -1)
+    {
+        std::cout << "Error: cannot remove stale socket " << address.sun_path << ": " << std::strerror(errno) << '\n';
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+} // namespace
+
+EventServer::EventServer(std::filesystem::path path) : m_path{std::move(path)}
+{
+#ifdef EVENT_SERVER_POSIX
+    auto address       = sockaddr_un{};
+    address.sun_family = AF_UNIX;
+    if (m_path.native().size() >= sizeof(address.sun_path))
+    {
+        std::cout << "Error: socket path " << m_path << " is too long\n";
+        return;
+    }
+    std::strcpy(address.sun_path, m_path.c_str());
+
+    if (!removeStaleSocket(address))
+        return;
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket == -1 || !setNonBlocking(m_socket) ||
+        bind(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1 ||
+        listen(m_socket, static_cast<int>(maxClients)) == -1)
+    {
+        std::cout << "Error: cannot listen on socket " << m_path << ": " << std::strerror(errno) << '\n';
+        if (m_socket != -1)
+            close(m_socket);
+        m_socket = -1;
+        return;
+    }
+
+    m_clients.reserve(maxClients);
+#else
+    std::cout << "Error: event streaming is only supported on POSIX systems\n";
+#endif
+}
+
+EventServer::~EventServer()
+{
+#ifdef EVENT_SERVER_POSIX
+    if (m_socket == -1)
+        return;
+
+    // Give the clients what is left, without waiting for them
+    flush();
+    for (const auto& client : m_clients)
+        close(client.socket);
+    close(m_socket);
+    unlink(m_path.c_str());
+#endif
+}
+
+bool EventServer::isOpen() const
+{
+    return m_socket != -1;
+}
+
+void EventServer::publish(const EventRecord& record)
+{
+    if (m_clients.empty())
+        return;
+
+    // After a drop everything is dropped until the client was told, so that it sees a single gap
+    const auto line = format(record);
+    for (auto& client : m_clients)
+    {
+        if (client.dropped == 0 && client.pending.size() + line.size() <= maxPending)
+            client.pending += line;
+        else
+            client.dropped++;
+    }
+}
+
+void EventServer::flush()
+{
+#ifdef EVENT_SERVER_POSIX
+    if (m_socket == -1)
+        return;
+
+    for (auto socket = accept(m_socket, nullptr, nullptr); socket != -1; socket = accept(m_socket, nullptr, nullptr))
+    {
+        if (m_clients.size() == maxClients || !setNonBlocking(socket))
+        {
+            close(socket);
+            continue;
+        }
+
+#ifdef SO_NOSIGPIPE
+        const int enable = 1;
+        setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+        m_clients.push_back({socket, {}, 0});
+        m_clients.back().pending.reserve(maxPending);
+    }
+
+    const auto disconnected = [](Client& client)
+    {
+        // Clients aren't expected to send anything, reading only detects that they are gone
+        char       discard[256];
+        const auto received = recv(client.socket, discard, sizeof(discard), MSG_DONTWAIT);
+        if (received == 0 || (received == -1 && errno != EAGAIN && errno != EWOULDBLOCK))
+            return true;
+
+        // Tell the client how many records it missed once its buffer has room again
+        if (client.dropped != 0 && client.pending.size() < maxPending / 2)
+        {
+            client.pending += "{\"dropped\":" + std::to_string(client.dropped) + "}\n";
+            client.dropped = 0;
+        }
+
+        if (client.pending.empty())
+            return false;
+
+        const auto sent = send(client.socket, client.pending.data(), client.pending.size(), sendFlags);
+        if (sent == -1)
+            return errno != EAGAIN && errno != EWOULDBLOCK;
+
+        client.pending.erase(0, static_cast<std::size_t>(sent));
+        return false;
+    };
+
+    for (auto it = m_clients.begin(); it != m_clients.end();)
+    {
+        if (disconnected(*it))
+        {
+            close(it->socket);
+            it = m_clients.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+#endif
+}
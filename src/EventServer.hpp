@@ -0,0 +1,41 @@
+#pragma once
+
+#include "EventRecord.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <cstdint>
+
+// Streams event records as JSON lines to the clients of a Unix domain socket
+class EventServer
+{
+public:
+    // Replaces a stale socket at path but no other file, the socket is removed again on destruction
+    explicit EventServer(std::filesystem::path path);
+    ~EventServer();
+
+    EventServer(const EventServer&)            = delete;
+    EventServer& operator=(const EventServer&) = delete;
+
+    bool isOpen() const;
+
+    // Only queues the record, records which don't fit into the buffer of a client are dropped and counted
+    void publish(const EventRecord& record);
+
+    // Accepts new clients and sends what is queued without blocking, meant to be called once per frame
+    void flush();
+
+private:
+    struct Client
+    {
+        int           socket;
+        std::string   pending;
+        std::uint64_t dropped = 0; // since the last report to the client
+    };
+
+    std::filesystem::path m_path;
+    int                   m_socket = -1;
+    std::vector<Client>   m_clients;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <cstddef>
+
+// Monotonic memory for what is built during one frame, released all at once when the next frame starts.
+// Only falls back to the heap when a frame needs more than the capacity.
+class FrameArena
+{
+public:
+    explicit FrameArena(std::size_t capacity) : m_buffer{new std::byte[capacity]}, m_capacity{capacity}
+    {
+    }
+
+    FrameArena(const FrameArena&)            = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        const auto offset = (m_used + alignment - 1) / alignment * alignment;
+        if (offset + size <= m_capacity)
+        {
+            m_used = offset + size;
+            return m_buffer.get() + offset;
+        }
+
+        return m_overflow.emplace_back(new std::byte[size]).get();
+    }
+
+    void reset()
+    {
+        m_used = 0;
+        m_overflow.clear();
+    }
+
+private:
+    std::unique_ptr<std::byte[]>              m_buffer;
+    std::size_t                               m_capacity;
+    std::size_t                               m_used = 0;
+    std::vector<std::unique_ptr<std::byte[]>> m_overflow; // allocations which didn't fit, freed on reset
+};
+
+// Standard allocator handing out the memory of a frame arena, deallocating does nothing until the arena is reset
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator(FrameArena& arena) : m_arena{&arena}
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : m_arena{other.m_arena}
+    {
+    }
+
+    T* allocate(std::size_t count)
+    {
+        return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t)
+    {
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+        return m_arena == other.m_arena;
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+        return m_arena != other.m_arena;
+    }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    FrameArena* m_arena;
+};
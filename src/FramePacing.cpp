@@ -0,0 +1,146 @@
+#include "FramePacing.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include <cmath>
+
+namespace
+{
+constexpr std::array<const char*, pacingCount> names = {"deadline", "fixed", "vsync", "uncapped"};
+
+const auto frameDuration = sf::seconds(1.f / static_cast<float>(frameRate));
+
+// Tenths of milliseconds are enough to tell a missed refresh apart
+void appendMilliseconds(TextBuilder& text, sf::Time time)
+{
+    const auto tenths = (time.asMicroseconds() + 50) / 100;
+    text += tenths / 10;
+    text += U'.';
+    text += tenths % 10;
+    text += " ms";
+}
+
+} // namespace
+
+const char* pacingName(Pacing pacing)
+{
+    return names[static_cast<std::size_t>(pacing)];
+}
+
+std::optional<Pacing> parsePacing(std::string_view name)
+{
+    for (std::size_t i = 0; i < names.size(); ++i)
+        if (name == names[i])
+            return static_cast<Pacing>(i);
+
+    return std::nullopt;
+}
+
+Pacing nextPacing(Pacing pacing)
+{
+    return static_cast<Pacing>((static_cast<std::size_t>(pacing) + 1) % pacingCount);
+}
+
+void DisplayTimer::reset(Pacing pacing)
+{
+    *this    = {};
+    m_pacing = pacing;
+}
+
+void DisplayTimer::add(sf::Time now)
+{
+    const auto last = std::exchange(m_last, now);
+    if (!last)
+        return;
+
+    const auto interval             = now - *last;
+    m_recent[m_count % recentCount] = interval;
+    m_longest                       = std::max(m_longest, interval);
+    ++m_count;
+
+    // The refresh period is the median of the recent intervals, found again every quarter of them rather than for
+    // every frame. The first intervals only establish it.
+    if (m_pacing == Pacing::VSync && m_count % (recentCount / 4) == 0)
+        m_refresh = median();
+
+    auto expected = sf::Time::Zero;
+    if (m_pacing == Pacing::Deadline || m_pacing == Pacing::Fixed)
+        expected = frameDuration;
+    else if (m_pacing == Pacing::VSync)
+        expected = m_refresh;
+
+    m_missed += expected != sf::Time::Zero && interval > expected + expected / std::int64_t{2};
+}
+
+void DisplayTimer::describe(TextBuilder& text) const
+{
+    const auto summary = summarize();
+
+    text += "Frame Pacing\t";
+    text += pacingName(m_pacing);
+    text += ", click to change\n\nInterval:\t";
+    appendMilliseconds(text, summary.mean);
+    text += "\tmean, ";
+    appendMilliseconds(text, summary.jitter);
+    text += " jitter\nSlowest:\t";
+    appendMilliseconds(text, summary.slowest);
+    text += "\t99th percentile, ";
+    appendMilliseconds(text, m_longest);
+    text += " at most\nMissed:\t";
+    if (m_pacing == Pacing::Uncapped)
+        text += "-";
+    else
+        text += m_missed;
+    text += "\tof ";
+    text += m_count;
+    text += " frames\n";
+}
+
+void DisplayTimer::print(std::ostream& os) const
+{
+    const auto summary = summarize();
+
+    os << "\tDisplay intervals, " << pacingName(m_pacing) << " pacing\n\n";
+    os << "Frames: " << m_count << ", " << m_missed << " missed their deadline\n";
+    os << "Last " << std::min<std::uint64_t>(m_count, recentCount) << " frames: " << summary.mean.asMicroseconds()
+       << " us mean, " << summary.jitter.asMicroseconds() << " us standard deviation, "
+       << summary.slowest.asMicroseconds() << " us 99th percentile\n";
+    os << "Longest: " << m_longest.asMicroseconds() << " us\n\n";
+}
+
+DisplayTimer::Summary DisplayTimer::summarize() const
+{
+    const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(m_count, recentCount));
+    if (count == 0)
+        return {};
+
+    auto sum = std::int64_t{0};
+    for (std::size_t i = 0; i < count; ++i)
+        sum += m_recent[i].asMicroseconds();
+    const auto mean = sum / static_cast<std::int64_t>(count);
+
+    auto squares = 0.0;
+    for (std::size_t i = 0; i < count; ++i)
+        squares += std::pow(static_cast<double>(m_recent[i].asMicroseconds() - mean), 2.0);
+
+    std::copy_n(m_recent.begin(), count, m_sorted.begin());
+    std::sort(m_sorted.begin(), m_sorted.begin() + static_cast<std::ptrdiff_t>(count));
+
+    return {sf::microseconds(mean),
+            sf::microseconds(static_cast<std::int64_t>(std::sqrt(squares / static_cast<double>(count)))),
+            m_sorted[(count - 1) / 2],
+            m_sorted[(count - 1) * 99 / 100]};
+}
+
+sf::Time DisplayTimer::median() const
+{
+    const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(m_count, recentCount));
+    if (count == 0)
+        return sf::Time::Zero;
+
+    const auto middle = m_sorted.begin() + static_cast<std::ptrdiff_t>((count - 1) / 2);
+    std::copy_n(m_recent.begin(), count, m_sorted.begin());
+    std::nth_element(m_sorted.begin(), middle, m_sorted.begin() + static_cast<std::ptrdiff_t>(count));
+    return *middle;
+}
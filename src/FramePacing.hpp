@@ -0,0 +1,63 @@
+#pragma once
+
+#include "TextBuilder.hpp"
+
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <optional>
+#include <ostream>
+#include <string_view>
+
+#include <cstdint>
+
+// How the frames are paced. With a deadline, the frames are drawn whenever the next one is due. Otherwise a render
+// thread draws them and display() waits, for the frame rate limit of SFML or for the vertical synchronization, or
+// doesn't wait at all. The events are polled between frames in every case.
+enum class Pacing
+{
+    Deadline,
+    Fixed,
+    VSync,
+    Uncapped,
+};
+
+inline constexpr std::size_t  pacingCount = 4;
+inline constexpr unsigned int frameRate   = 15; // of the deadline and of the fixed limit
+
+const char*           pacingName(Pacing pacing);
+std::optional<Pacing> parsePacing(std::string_view name);
+Pacing                nextPacing(Pacing pacing);
+
+// Intervals between the frames handed over to the display, measured right after display() returns. A deadline is
+// missed when an interval lasts half a frame longer than expected, frames with vertical synchronization are expected
+// to last the median interval and uncapped frames have no deadline.
+class DisplayTimer
+{
+public:
+    // Starts over, as the intervals of another pacing aren't comparable
+    void reset(Pacing pacing);
+    void add(sf::Time now);
+
+    void describe(TextBuilder& text) const;
+    void print(std::ostream& os) const;
+
+private:
+    struct Summary
+    {
+        sf::Time mean, jitter, median, slowest; // jitter is the standard deviation, slowest the 99th percentile
+    };
+
+    Summary  summarize() const;
+    sf::Time median() const;
+
+    static constexpr std::size_t recentCount = 256; // intervals summarized
+
+    Pacing                  m_pacing = Pacing::Deadline;
+    std::optional<sf::Time> m_last;
+    std::uint64_t           m_count = 0, m_missed = 0;
+    sf::Time                m_longest, m_refresh; // m_refresh is the expected interval with vertical synchronization
+
+    std::array<sf::Time, recentCount>         m_recent; // ring of the last intervals
+    mutable std::array<sf::Time, recentCount> m_sorted; // scratch space, so that percentiles cost no allocation
+};
@@ -0,0 +1,156 @@
+#include "FrameRecorder.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <SFML/OpenGL.hpp>
+
+#include <SFML/System/Sleep.hpp>
+
+#include <algorithm>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace
+{
+// Zero padded so that the files of a recording sort in frame order
+std::string fileName(std::uint64_t recording, std::uint64_t frame)
+{
+    auto number = std::to_string(frame);
+    number.insert(0, number.size() < 8 ? 8 - number.size() : 0, '0');
+
+    return "recording-" + std::to_string(recording) + "-frame-" + number + ".png";
+}
+
+} // namespace
+
+FrameRecorder::FrameRecorder(sf::Vector2u          size,
+                             std::size_t           framesBefore,
+                             std::size_t           framesAfter,
+                             std::filesystem::path directory) :
+m_size{size},
+m_framesBefore{framesBefore},
+m_framesAfter{framesAfter},
+m_directory{std::move(directory)},
+m_slots(framesBefore + framesAfter + 2) // so that the next frames have room while a recording is written
+{
+    for (auto& slot : m_slots)
+        slot.pixels.resize(std::size_t{size.x} * size.y * 4);
+
+    auto error = std::error_code{};
+    std::filesystem::create_directories(m_directory, error);
+
+    m_thread = std::thread{&FrameRecorder::run, this};
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    m_running = false;
+    m_thread.join();
+}
+
+void FrameRecorder::capture(sf::RenderWindow& window)
+{
+    const auto isQueued = [&](std::size_t index)
+    { return m_slots[index].state.load(std::memory_order_acquire) == State::Queued; };
+
+    // Slots waiting to be written are skipped, if all of them are the frame is lost
+    auto index = m_next;
+    for (std::size_t i = 1; i < m_slots.size() && isQueued(index); ++i)
+        index = (index + 1) % m_slots.size();
+
+    auto& slot = m_slots[index];
+    if (isQueued(index) || !window.setActive())
+    {
+        ++m_dropped;
+        ++m_frame;
+        return;
+    }
+    m_next = (index + 1) % m_slots.size();
+
+    // Top left part of the window if it grew, OpenGL counts the rows from the bottom
+    const auto windowSize = window.getSize();
+    slot.size             = {std::min(windowSize.x, m_size.x), std::min(windowSize.y, m_size.y)};
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0,
+                 static_cast<GLint>(windowSize.y - slot.size.y),
+                 static_cast<GLsizei>(slot.size.x),
+                 static_cast<GLsizei>(slot.size.y),
+                 GL_RGBA,
+                 GL_UNSIGNED_BYTE,
+                 slot.pixels.data());
+
+    slot.frame     = m_frame++;
+    slot.recording = m_recording;
+    if (m_afterRemaining > 0)
+    {
+        --m_afterRemaining;
+        slot.state.store(State::Queued, std::memory_order_release);
+    }
+    else
+    {
+        slot.state.store(State::Filled, std::memory_order_release);
+    }
+}
+
+bool FrameRecorder::trigger()
+{
+    const auto started = m_afterRemaining == 0;
+    if (started)
+    {
+        ++m_recording;
+        for (auto& slot : m_slots)
+        {
+            if (slot.state.load(std::memory_order_relaxed) != State::Filled || slot.frame + m_framesBefore < m_frame)
+                continue;
+
+            slot.recording = m_recording;
+            slot.state.store(State::Queued, std::memory_order_release);
+        }
+    }
+
+    // Another anomaly during a recording extends it
+    m_afterRemaining = m_framesAfter;
+
+    return started;
+}
+
+void FrameRecorder::print(std::ostream& os) const
+{
+    os << "\tFrame recorder\n\n";
+    os << "Recordings: " << m_recording << ", frames written to " << m_directory.string() << ": " << m_written
+       << ", failed to write: " << m_failed << ", dropped: " << m_dropped << "\n\n";
+}
+
+void FrameRecorder::run()
+{
+    // Reused so that its pixels are only allocated once
+    auto image = sf::Image{};
+
+    // The frames queued when the recorder is destroyed are still written
+    while (true)
+    {
+        auto* oldest = static_cast<Slot*>(nullptr);
+        for (auto& slot : m_slots)
+            if (slot.state.load(std::memory_order_acquire) == State::Queued && (!oldest || slot.frame < oldest->frame))
+                oldest = &slot;
+
+        if (!oldest)
+        {
+            if (!m_running)
+                break;
+
+            sf::sleep(sf::milliseconds(10));
+            continue;
+        }
+
+        image.resize(oldest->size, oldest->pixels.data());
+        image.flipVertically();
+        if (image.saveToFile(m_directory / fileName(oldest->recording, oldest->frame)))
+            ++m_written;
+        else
+            ++m_failed;
+
+        oldest->state.store(State::Empty, std::memory_order_release);
+    }
+}
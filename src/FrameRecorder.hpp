@@ -0,0 +1,74 @@
+#pragma once
+
+#include <SFML/Graphics/RenderWindow.hpp>
+
+#include <SFML/System/Vector2.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include <cstdint>
+
+// Keeps the last frames of the window in memory and, when an anomaly is triggered, writes the frames before and after
+// it as PNG files from a thread of its own, so the render loop never waits for encoding or the disk
+class FrameRecorder
+{
+public:
+    // Memory for all frames is allocated here, at the size of the window, a larger window is captured partially
+    FrameRecorder(sf::Vector2u          size,
+                  std::size_t           framesBefore,
+                  std::size_t           framesAfter,
+                  std::filesystem::path directory);
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&)            = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // Copies the frame drawn to the window, must be called before display since the back buffer is undefined after
+    void capture(sf::RenderWindow& window);
+
+    // Returns true if this started a recording, triggers during a recording are part of it
+    bool trigger();
+
+    // Recordings and frames written, and frames lost because the writing thread fell behind
+    void print(std::ostream& os) const;
+
+private:
+    void run();
+
+    enum class State : std::uint8_t
+    {
+        Empty,
+        Filled, // a recent frame, the render thread may overwrite it
+        Queued, // part of a recording, owned by the writing thread until it is written
+    };
+
+    struct Slot
+    {
+        std::vector<std::uint8_t> pixels; // RGBA, bottom row first as OpenGL reads them
+        sf::Vector2u              size;
+        std::uint64_t             frame     = 0;
+        std::uint64_t             recording = 0;
+        std::atomic<State>        state{State::Empty};
+    };
+
+    const sf::Vector2u          m_size;
+    const std::size_t           m_framesBefore, m_framesAfter;
+    const std::filesystem::path m_directory;
+
+    std::vector<Slot> m_slots;
+
+    // Accessed by the render thread only
+    std::size_t   m_next           = 0;
+    std::uint64_t m_frame          = 0;
+    std::uint64_t m_recording      = 0;
+    std::size_t   m_afterRemaining = 0;
+
+    std::atomic<std::uint64_t> m_written{0}, m_failed{0}, m_dropped{0};
+
+    std::atomic<bool> m_running{true};
+    std::thread       m_thread;
+};
@@ -0,0 +1,82 @@
+#include "GlyphCache.hpp"
+
+namespace
+{
+// Same quads as sf::Text, with the padding which keeps the neighbors of a glyph in the texture out of it
+void appendQuad(std::vector<sf::Vertex>& vertices, float x, float y, const sf::Glyph& glyph)
+{
+    constexpr auto padding = 1.f;
+
+    const auto left   = x + glyph.bounds.position.x - padding;
+    const auto top    = y + glyph.bounds.position.y - padding;
+    const auto right  = x + glyph.bounds.position.x + glyph.bounds.size.x + padding;
+    const auto bottom = y + glyph.bounds.position.y + glyph.bounds.size.y + padding;
+
+    const auto u1 = static_cast<float>(glyph.textureRect.position.x) - padding;
+    const auto v1 = static_cast<float>(glyph.textureRect.position.y) - padding;
+    const auto u2 = static_cast<float>(glyph.textureRect.position.x + glyph.textureRect.size.x) + padding;
+    const auto v2 = static_cast<float>(glyph.textureRect.position.y + glyph.textureRect.size.y) + padding;
+
+    vertices.push_back({{left, top}, sf::Color::White, {u1, v1}});
+    vertices.push_back({{right, top}, sf::Color::White, {u2, v1}});
+    vertices.push_back({{left, bottom}, sf::Color::White, {u1, v2}});
+    vertices.push_back({{left, bottom}, sf::Color::White, {u1, v2}});
+    vertices.push_back({{right, top}, sf::Color::White, {u2, v1}});
+    vertices.push_back({{right, bottom}, sf::Color::White, {u2, v2}});
+}
+
+} // namespace
+
+GlyphCache::GlyphCache(const sf::Font& font, unsigned int characterSize, float outlineThickness) :
+m_font{font},
+m_characterSize{characterSize},
+m_outlineThickness{outlineThickness}
+{
+}
+
+const GlyphCache::Fragment& GlyphCache::get(std::u32string_view text)
+{
+    if (const auto it = m_fragments.find(text); it != m_fragments.end())
+        return it->second;
+
+    if (m_fragments.size() == capacity)
+        m_fragments.clear();
+
+    return m_fragments.emplace(text, layOut(text)).first->second;
+}
+
+const sf::Texture& GlyphCache::getTexture() const
+{
+    return m_font.getTexture(m_characterSize);
+}
+
+GlyphCache::Fragment GlyphCache::layOut(std::u32string_view text) const
+{
+    auto       fragment = Fragment{};
+    const auto y        = static_cast<float>(m_characterSize);
+    fragment.fill.reserve(text.size() * 6);
+    if (m_outlineThickness != 0.f)
+        fragment.outline.reserve(text.size() * 6);
+
+    auto previous = char32_t{0};
+    for (const auto character : text)
+    {
+        fragment.width += m_font.getKerning(previous, character, m_characterSize);
+        previous = character;
+
+        const auto& glyph = m_font.getGlyph(character, m_characterSize, false);
+        if (character != U' ')
+        {
+            appendQuad(fragment.fill, fragment.width, y, glyph);
+            if (m_outlineThickness != 0.f)
+                appendQuad(fragment.outline,
+                           fragment.width,
+                           y,
+                           m_font.getGlyph(character, m_characterSize, false, m_outlineThickness));
+        }
+
+        fragment.width += glyph.advance;
+    }
+
+    return fragment;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Glyph quads of the text fragments of the panels, a fragment is laid out once and copied wherever it is shown again
+class GlyphCache
+{
+public:
+    struct Fragment
+    {
+        std::vector<sf::Vertex> fill, outline; // triangles, the baseline is at the character size
+        float                   width = 0.f;
+    };
+
+    GlyphCache(const sf::Font& font, unsigned int characterSize, float outlineThickness);
+
+    // The reference is only valid until the next call, the cache is emptied when it gets too large
+    const Fragment& get(std::u32string_view text);
+
+    const sf::Texture& getTexture() const;
+
+private:
+    Fragment layOut(std::u32string_view text) const;
+
+    // Numbers make most fragments unique, the identifiers and labels are laid out again after a clear
+    static constexpr std::size_t capacity = 4096;
+
+    const sf::Font&    m_font;
+    const unsigned int m_characterSize;
+    const float        m_outlineThickness;
+
+    std::map<std::u32string, Fragment, std::less<>> m_fragments;
+};
@@ -0,0 +1,90 @@
+#include "InputSnapshot.hpp"
+
+#include "EvdevReader.hpp"
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <X11/Xlib.h>
+#define INPUT_SNAPSHOT_X11
+#endif
+
+InputSnapshot::InputSnapshot()
+{
+    m_keycodeInputs.fill(inputCount);
+    m_sampled.fill(true);
+
+#ifdef INPUT_SNAPSHOT_X11
+    // The extra buttons are not part of the pointer state, SFML never reports them pressed with X11 either
+    m_sampled[sf::Keyboard::ScancodeCount + static_cast<std::size_t>(sf::Mouse::Button::Extra1)] = false;
+    m_sampled[sf::Keyboard::ScancodeCount + static_cast<std::size_t>(sf::Mouse::Button::Extra2)] = false;
+
+    m_display = XOpenDisplay(nullptr);
+    if (!m_display)
+        return;
+
+    // SFML maps the keycodes of the evdev driver, which are the Linux input codes plus 8
+    std::fill_n(m_sampled.begin(), sf::Keyboard::ScancodeCount, false);
+    for (std::size_t keycode = 8; keycode < m_keycodeInputs.size(); ++keycode)
+        if (const auto input = linuxCodeToInput(static_cast<std::uint16_t>(keycode - 8));
+            input && *input < sf::Keyboard::ScancodeCount)
+        {
+            m_keycodeInputs[keycode] = static_cast<std::uint16_t>(*input);
+            m_sampled[*input]        = true;
+        }
+#endif
+}
+
+InputSnapshot::~InputSnapshot()
+{
+#ifdef INPUT_SNAPSHOT_X11
+    if (m_display)
+        XCloseDisplay(static_cast<Display*>(m_display));
+#endif
+}
+
+const InputSnapshot::State& InputSnapshot::read()
+{
+#ifdef INPUT_SNAPSHOT_X11
+    if (m_display)
+    {
+        auto* const display = static_cast<Display*>(m_display);
+        m_state.fill(false);
+
+        char keys[32];
+        XQueryKeymap(display, keys);
+        for (std::size_t keycode = 0; keycode < m_keycodeInputs.size(); ++keycode)
+            if ((keys[keycode / 8] >> (keycode % 8)) & 1 && m_keycodeInputs[keycode] != inputCount)
+                m_state[m_keycodeInputs[keycode]] = true;
+
+        auto         root = Window{}, child = Window{};
+        auto         rootX = 0, rootY = 0, windowX = 0, windowY = 0;
+        unsigned int mask = 0;
+        XQueryPointer(display, DefaultRootWindow(display), &root, &child, &rootX, &rootY, &windowX, &windowY, &mask);
+
+        const auto setButton = [&](sf::Mouse::Button button, unsigned int buttonMask)
+        { m_state[sf::Keyboard::ScancodeCount + static_cast<std::size_t>(button)] = (mask & buttonMask) != 0; };
+        setButton(sf::Mouse::Button::Left, Button1Mask);
+        setButton(sf::Mouse::Button::Middle, Button2Mask);
+        setButton(sf::Mouse::Button::Right, Button3Mask);
+
+        return m_state;
+    }
+#endif
+
+    for (std::size_t input = 0; input < inputCount; ++input)
+    {
+        if (input < sf::Keyboard::ScancodeCount)
+            m_state[input] = sf::Keyboard::isKeyPressed(static_cast<sf::Keyboard::Scancode>(input));
+        else
+            m_state[input] = sf::Mouse::isButtonPressed(
+                static_cast<sf::Mouse::Button>(input - sf::Keyboard::ScancodeCount));
+    }
+
+    return m_state;
+}
+
+const InputSnapshot::State& InputSnapshot::sampled() const
+{
+    return m_sampled;
+}
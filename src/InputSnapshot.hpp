@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SFML/Window/Keyboard.hpp>
+#include <SFML/Window/Mouse.hpp>
+
+#include <array>
+
+#include <cstdint>
+
+// Reads the pressed state of every scancode and mouse button at once. With X11 this takes two requests to the X
+// server on a connection of its own, rather than the one request per input of sf::Keyboard::isKeyPressed and
+// sf::Mouse::isButtonPressed. Elsewhere, or without an X server, every input is queried from SFML, which only reads
+// the state kept by the system on Windows. Not thread-safe, it is to be used by the thread handling the events.
+class InputSnapshot
+{
+public:
+    static constexpr auto inputCount = sf::Keyboard::ScancodeCount + sf::Mouse::ButtonCount;
+
+    // Indexed by scancode, then sf::Keyboard::ScancodeCount + button
+    using State = std::array<bool, inputCount>;
+
+    InputSnapshot();
+    ~InputSnapshot();
+
+    InputSnapshot(const InputSnapshot&)            = delete;
+    InputSnapshot& operator=(const InputSnapshot&) = delete;
+
+    const State& read();
+
+    // Inputs read() can see pressed, the others always read as released
+    const State& sampled() const;
+
+private:
+    void* m_display = nullptr; // an X11 Display, kept opaque so that Xlib and its macros stay in the source file
+
+    // Input of every X11 keycode, inputCount if it has none
+    std::array<std::uint16_t, 256> m_keycodeInputs{};
+
+    State m_state{};
+    State m_sampled{};
+};
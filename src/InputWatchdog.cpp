@@ -0,0 +1,166 @@
+#include "InputWatchdog.hpp"
+
+#include <utility>
+
+namespace
+{
+// Held longer than this, the key is probably stuck or weighed down
+constexpr auto stuckThreshold = sf::seconds(10.f);
+
+constexpr auto checkInterval = sf::milliseconds(250);
+
+bool isPressed(std::size_t input)
+{
+    if (input < sf::Keyboard::ScancodeCount)
+        return sf::Keyboard::isKeyPressed(static_cast<sf::Keyboard::Scancode>(input));
+
+    return sf::Mouse::isButtonPressed(static_cast<sf::Mouse::Button>(input - sf::Keyboard::ScancodeCount));
+}
+
+} // namespace
+
+InputWatchdog::InputWatchdog()
+{
+    m_active.reserve(inputCount);
+}
+
+void InputWatchdog::handle(const sf::Event& event, sf::Time timestamp)
+{
+    if (event.is<sf::Event::FocusLost>())
+    {
+        for (const auto input : m_active)
+            m_inputs[input].state = State::Unfocused;
+    }
+    else if (event.is<sf::Event::FocusGained>())
+    {
+        m_adoptState = true;
+    }
+    else if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>())
+    {
+        if (keyPressed->scancode != sf::Keyboard::Scan::Unknown)
+            press(static_cast<std::size_t>(keyPressed->scancode), timestamp);
+    }
+    else if (const auto* keyReleased = event.getIf<sf::Event::KeyReleased>())
+    {
+        if (keyReleased->scancode != sf::Keyboard::Scan::Unknown)
+            release(static_cast<std::size_t>(keyReleased->scancode), timestamp);
+    }
+    else if (const auto* buttonPressed = event.getIf<sf::Event::MouseButtonPressed>())
+    {
+        press(sf::Keyboard::ScancodeCount + static_cast<std::size_t>(buttonPressed->button), timestamp);
+    }
+    else if (const auto* buttonReleased = event.getIf<sf::Event::MouseButtonReleased>())
+    {
+        release(sf::Keyboard::ScancodeCount + static_cast<std::size_t>(buttonReleased->button), timestamp);
+    }
+}
+
+const std::vector<EventRecord>& InputWatchdog::check(sf::Time now)
+{
+    // Releases which went to another window are lost, presses made there will be released here
+    if (m_adoptState)
+    {
+        m_adoptState = false;
+        for (std::size_t input = 0; input < inputCount; ++input)
+        {
+            const auto pressed = isPressed(input);
+            if (m_inputs[input].state == State::Unfocused && !pressed)
+            {
+                report(EventRecord::Type::LostRelease, input, now);
+                deactivate(input);
+            }
+            else if (m_inputs[input].state == State::Unfocused)
+            {
+                m_inputs[input].state = State::Pressed;
+            }
+            else if (m_inputs[input].state == State::Released && pressed)
+            {
+                press(input, now);
+            }
+        }
+    }
+
+    // Only the held inputs are checked, and not every frame
+    if (now >= m_nextCheck)
+    {
+        m_nextCheck = now + checkInterval;
+        for (std::size_t i = 0; i < m_active.size();)
+        {
+            const auto input = m_active[i];
+            auto&      state = m_inputs[input];
+
+            // A release can be on its way while the state is checked, so it only counts if it is seen twice
+            if (state.state == State::Unfocused || isPressed(input))
+            {
+                state.sampledReleasedAt = sf::Time::Zero;
+            }
+            else if (state.sampledReleasedAt == sf::Time::Zero)
+            {
+                state.sampledReleasedAt = now;
+            }
+            else
+            {
+                report(EventRecord::Type::MissingRelease, input, state.sampledReleasedAt);
+                deactivate(input);
+                continue;
+            }
+
+            if (state.state == State::Pressed && now - state.pressedAt > stuckThreshold)
+            {
+                state.state = State::Stuck;
+                report(EventRecord::Type::StuckPress, input, state.pressedAt);
+            }
+            ++i;
+        }
+    }
+
+    m_reported.clear();
+    std::swap(m_reported, m_findings);
+
+    return m_reported;
+}
+
+void InputWatchdog::press(std::size_t input, sf::Time timestamp)
+{
+    // Key repeats keep the time of the first press
+    auto& state = m_inputs[input];
+    if (state.state != State::Released)
+        return;
+
+    state.state             = State::Pressed;
+    state.pressedAt         = timestamp;
+    state.sampledReleasedAt = sf::Time::Zero;
+    state.activeIndex       = static_cast<std::uint16_t>(m_active.size());
+    m_active.push_back(static_cast<std::uint16_t>(input));
+}
+
+void InputWatchdog::release(std::size_t input, sf::Time timestamp)
+{
+    if (m_inputs[input].state == State::Released)
+        report(EventRecord::Type::ReleaseWithoutPress, input, timestamp);
+    else
+        deactivate(input);
+}
+
+void InputWatchdog::deactivate(std::size_t input)
+{
+    auto& state = m_inputs[input];
+    state.state = State::Released;
+
+    // Swap with the last one to remove in constant time
+    const auto last             = m_active.back();
+    m_active[state.activeIndex] = last;
+    m_inputs[last].activeIndex  = state.activeIndex;
+    m_active.pop_back();
+}
+
+void InputWatchdog::report(EventRecord::Type type, std::size_t input, sf::Time timestamp)
+{
+    auto& record     = m_findings.emplace_back();
+    record.timestamp = timestamp.asMicroseconds();
+    record.type      = type;
+    if (input < sf::Keyboard::ScancodeCount)
+        record.scancode = static_cast<std::int16_t>(input);
+    else
+        record.code = static_cast<std::int16_t>(input - sf::Keyboard::ScancodeCount);
+}
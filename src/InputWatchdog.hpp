@@ -0,0 +1,58 @@
+#pragma once
+
+#include "EventRecord.hpp"
+
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Keyboard.hpp>
+#include <SFML/Window/Mouse.hpp>
+
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <vector>
+
+#include <cstdint>
+
+// Follows every key and button through presses and releases and reports the transitions which should not happen
+class InputWatchdog
+{
+public:
+    InputWatchdog();
+
+    // Constant time, findings are collected until the next check
+    void handle(const sf::Event& event, sf::Time timestamp);
+
+    // Compares the held inputs with their state, returns the findings since the last call as records
+    const std::vector<EventRecord>& check(sf::Time now);
+
+private:
+    static constexpr auto inputCount = sf::Keyboard::ScancodeCount + sf::Mouse::ButtonCount;
+
+    enum class State : std::uint8_t
+    {
+        Released,
+        Pressed,
+        Stuck,     // pressed for longer than the threshold and reported
+        Unfocused, // pressed when the focus was lost, the release may go to another window
+    };
+
+    struct Input
+    {
+        State         state = State::Released;
+        sf::Time      pressedAt;
+        sf::Time      sampledReleasedAt; // zero unless the state disagreed with the last check
+        std::uint16_t activeIndex = 0;   // position in m_active unless released
+    };
+
+    void press(std::size_t input, sf::Time timestamp);
+    void release(std::size_t input, sf::Time timestamp);
+    void deactivate(std::size_t input);
+    void report(EventRecord::Type type, std::size_t input, sf::Time timestamp);
+
+    std::array<Input, inputCount> m_inputs;
+    std::vector<std::uint16_t>    m_active; // inputs which are not released, so checks don't visit all of them
+    bool                          m_adoptState = true; // after gaining focus, held inputs are taken as pressed
+    sf::Time                      m_nextCheck;
+    std::vector<EventRecord>      m_findings;
+    std::vector<EventRecord>      m_reported; // returned by check
+};
@@ -0,0 +1,137 @@
+#include "KeyStatistics.hpp"
+
+#include "ranges.hpp"
+#include "strings.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+#include <cmath>
+
+namespace
+{
+// Presses closer than this to the previous release of the same key are bounces of a worn switch
+constexpr auto chatterThreshold = sf::milliseconds(10);
+
+std::size_t holdBucket(sf::Time holdTime, std::size_t bucketCount)
+{
+    auto bucket = std::size_t{0};
+    for (auto milliseconds = holdTime.asMilliseconds(); 0 < milliseconds && bucket + 1 < bucketCount; milliseconds /= 2)
+        ++bucket;
+
+    return bucket;
+}
+
+// Upper bound in milliseconds of the bucket containing the given percentile
+template <typename Histogram>
+std::string holdPercentile(const Histogram& histogram, std::uint32_t total, std::uint32_t percent)
+{
+    auto count = std::uint32_t{0};
+    for (std::size_t bucket = 0; bucket < histogram.size(); ++bucket)
+    {
+        count += histogram[bucket];
+        if (total * percent > count * 100)
+            continue;
+
+        if (bucket + 1 == histogram.size())
+            return ">" + std::to_string(1 << (bucket - 1));
+        return "<" + std::to_string(1 << bucket);
+    }
+
+    return "-";
+}
+
+} // namespace
+
+std::optional<sf::Time> KeyStatistics::handle(const sf::Event& event, sf::Time timestamp)
+{
+    if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>())
+    {
+        if (keyPressed->scancode == sf::Keyboard::Scan::Unknown)
+            return std::nullopt;
+
+        auto& key = m_keys[keyPressed->scancode];
+
+        // Pressed events while the key is down come from autorepeat
+        if (key.down)
+        {
+            ++key.repeats;
+            if (key.lastRepeat < key.lastPress)
+            {
+                key.repeatDelaySum += timestamp - key.lastPress;
+                ++key.repeatDelayCount;
+            }
+            else
+            {
+                key.repeatIntervalSum += timestamp - key.lastRepeat;
+                ++key.repeatIntervalCount;
+            }
+            key.lastRepeat = timestamp;
+
+            return std::nullopt;
+        }
+
+        key.down      = true;
+        key.lastPress = timestamp;
+        m_maxPresses  = std::max(m_maxPresses, ++key.presses);
+
+        if (const auto sinceRelease = timestamp - key.lastRelease;
+            sf::Time::Zero <= key.lastRelease && sinceRelease < chatterThreshold)
+        {
+            ++key.chatter;
+            return sinceRelease;
+        }
+    }
+    else if (const auto* keyReleased = event.getIf<sf::Event::KeyReleased>())
+    {
+        if (keyReleased->scancode == sf::Keyboard::Scan::Unknown)
+            return std::nullopt;
+
+        auto& key = m_keys[keyReleased->scancode];
+        if (key.down)
+            ++key.holdTimes[holdBucket(timestamp - key.lastPress, holdBucketCount)];
+
+        key.down        = false;
+        key.lastRelease = timestamp;
+    }
+
+    return std::nullopt;
+}
+
+float KeyStatistics::getHeat(sf::Keyboard::Scancode scancode) const
+{
+    if (m_maxPresses == 0)
+        return 0.f;
+
+    return static_cast<float>(m_keys[scancode].presses) / static_cast<float>(m_maxPresses);
+}
+
+void KeyStatistics::print(std::ostream& os) const
+{
+    os << "\tKey statistics (hold times in ms, repeat delay in ms, repeat rate in Hz)\n\n";
+    os << std::left << std::setw(28) << "scancode" << std::right << std::setw(8) << "presses" << std::setw(8)
+       << "repeats" << std::setw(8) << "chatter" << std::setw(8) << "hold50" << std::setw(8) << "hold90"
+       << std::setw(8) << "delay" << std::setw(8) << "rate" << '\n';
+
+    for (auto scancode : scancodes)
+    {
+        const auto& key = m_keys[scancode];
+        if (key.presses == 0)
+            continue;
+
+        auto holds = std::uint32_t{0};
+        for (auto count : key.holdTimes)
+            holds += count;
+
+        const auto delay = key.repeatDelayCount == 0 ? 0 : key.repeatDelaySum.asMilliseconds() / key.repeatDelayCount;
+        const auto rate  = key.repeatIntervalCount == 0 || key.repeatIntervalSum == sf::Time::Zero
+                               ? 0l
+                               : std::lround(key.repeatIntervalCount / key.repeatIntervalSum.asSeconds());
+
+        os << std::left << std::setw(28) << scancodeIdentifier(scancode) << std::right << std::setw(8) << key.presses
+           << std::setw(8) << key.repeats << std::setw(8) << key.chatter << std::setw(8)
+           << holdPercentile(key.holdTimes, holds, 50) << std::setw(8) << holdPercentile(key.holdTimes, holds, 90)
+           << std::setw(8) << delay << std::setw(8) << rate << '\n';
+    }
+    os << '\n';
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ranges.hpp"
+
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Keyboard.hpp>
+
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <optional>
+#include <ostream>
+
+#include <cstdint>
+
+// Press counts, hold times, autorepeat timing and switch chatter for every scancode
+class KeyStatistics
+{
+public:
+    // Returns the time since the last release if the event is a press bouncing right after it (switch chatter)
+    std::optional<sf::Time> handle(const sf::Event& event, sf::Time timestamp);
+
+    // Presses of the key relative to the most pressed key, between 0 and 1
+    float getHeat(sf::Keyboard::Scancode scancode) const;
+
+    void print(std::ostream& os) const;
+
+private:
+    // Bucket 0 counts holds shorter than 1 ms, bucket i holds between 2^(i-1) and 2^i ms
+    // and the last bucket everything longer
+    static constexpr std::size_t holdBucketCount = 16;
+
+    struct Key
+    {
+        bool     down = false;
+        sf::Time lastPress;
+        sf::Time lastRelease{sf::seconds(-1.f)};
+        sf::Time lastRepeat;
+
+        std::uint32_t presses = 0;
+        std::uint32_t repeats = 0;
+        std::uint32_t chatter = 0;
+
+        std::array<std::uint32_t, holdBucketCount> holdTimes{};
+
+        sf::Time      repeatDelaySum; // from the press to the first repeat
+        std::uint32_t repeatDelayCount = 0;
+        sf::Time      repeatIntervalSum; // between two repeats
+        std::uint32_t repeatIntervalCount = 0;
+    };
+
+    EnumMap<sf::Keyboard::Scancode, Key> m_keys;
+    std::uint32_t                        m_maxPresses = 0;
+};
@@ -0,0 +1,125 @@
+#include "KeyboardLayout.hpp"
+
+#include "ranges.hpp"
+#include "strings.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <cstdlib>
+
+namespace
+{
+// Returns false unless the whole text is a number of units between min and max
+bool parseUnits(const std::string& text, float min, float max, float& units)
+{
+    char* end = nullptr;
+    units     = std::strtof(text.c_str(), &end);
+    return !text.empty() && end == text.c_str() + text.size() && min <= units && units <= max;
+}
+
+std::optional<sf::Keyboard::Scancode> parseScancode(const std::string& name)
+{
+    for (auto scancode : scancodes)
+        if (scancodeIdentifier(scancode) == "Scan::" + name)
+            return scancode;
+
+    return std::nullopt;
+}
+
+} // namespace
+
+std::optional<KeyboardLayout> compileLayout(std::string name, std::istream& source, std::string& error)
+{
+    constexpr auto maxUnits = 64.f;
+
+    auto layout = KeyboardLayout{std::move(name), {}, {}};
+    auto seen   = EnumBitset<sf::Keyboard::Scancode>{};
+    auto y      = 0.f;
+
+    auto lineNumber = 0;
+    for (auto line = std::string{}; std::getline(source, line);)
+    {
+        ++lineNumber;
+        const auto fail = [&](const std::string& message)
+        {
+            error = "line " + std::to_string(lineNumber) + ": " + message;
+            return std::nullopt;
+        };
+
+        auto tokens = std::istringstream{line.substr(0, line.find('#'))};
+        auto x      = 0.f;
+        auto space  = 0.f;
+        auto hasKey = false;
+        for (auto token = std::string{}; tokens >> token;)
+        {
+            if (token.front() == '+')
+            {
+                auto units = 0.f;
+                if (!parseUnits(token.substr(1), 0.f, maxUnits, units))
+                    return fail("invalid space " + token);
+
+                x += units * KeyboardLayout::keySize;
+                space += units * KeyboardLayout::keySize;
+                continue;
+            }
+
+            const auto colon    = token.find(':');
+            const auto scancode = parseScancode(token.substr(0, colon));
+            if (!scancode)
+                return fail("unknown scancode " + token.substr(0, colon));
+            if (seen[*scancode])
+                return fail("scancode " + token.substr(0, colon) + " appears twice");
+            seen.set(*scancode);
+
+            auto size = sf::Vector2f{1.f, 1.f};
+            if (colon != std::string::npos)
+            {
+                const auto units = token.substr(colon + 1);
+                const auto times = units.find('x');
+                if (!parseUnits(units.substr(0, times), 0.25f, maxUnits, size.x) ||
+                    (times != std::string::npos && !parseUnits(units.substr(times + 1), 0.25f, maxUnits, size.y)))
+                    return fail("invalid size " + token);
+            }
+
+            auto& cell        = layout.cells.emplace_back();
+            cell.scancode     = *scancode;
+            cell.rect         = {{x, y}, size * KeyboardLayout::keySize};
+            cell.labelCenter  = cell.rect.position + cell.rect.size / 2.f;
+            cell.labelWidth   = cell.rect.size.x - KeyboardLayout::padding * 2.f - 2.f;
+            cell.vertexOffset = static_cast<std::uint16_t>(6 * (layout.cells.size() - 1));
+
+            layout.size.x = std::max(layout.size.x, cell.rect.position.x + cell.rect.size.x);
+            layout.size.y = std::max(layout.size.y, cell.rect.position.y + cell.rect.size.y);
+            x += cell.rect.size.x;
+            hasKey = true;
+        }
+
+        y += hasKey ? KeyboardLayout::keySize : space;
+    }
+
+    if (layout.cells.empty())
+    {
+        error = "no keys";
+        return std::nullopt;
+    }
+
+    return layout;
+}
+
+std::optional<KeyboardLayout> loadLayout(const std::filesystem::path& path, std::string& error)
+{
+    auto file = std::ifstream{path};
+    if (!file)
+    {
+        error = "cannot open " + path.string();
+        return std::nullopt;
+    }
+
+    auto layout = compileLayout(path.stem().string(), file, error);
+    if (!layout)
+        error = path.string() + ": " + error;
+
+    return layout;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include <SFML/Window/Keyboard.hpp>
+
+#include <SFML/System/Vector2.hpp>
+
+#include <filesystem>
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <cstdint>
+
+// Physical arrangement of the keys, compiled from a layout file so that drawing doesn't need to walk rows
+struct KeyboardLayout
+{
+    static constexpr auto keySize = 64.f; // pixels per unit
+    static constexpr auto padding = 4.f;
+
+    struct Cell
+    {
+        sf::Keyboard::Scancode scancode;
+        sf::FloatRect          rect; // relative to the top left corner of the keyboard
+        sf::Vector2f           labelCenter;
+        float                  labelWidth;   // available to the label inside the padding
+        std::uint16_t          vertexOffset; // first of the 6 vertices of the key
+    };
+
+    std::string       name;
+    std::vector<Cell> cells;
+    sf::Vector2f      size;
+};
+
+// One row of keys per line, keys are scancode names as in sf::Keyboard::Scan. Name:W makes a key W units wide,
+// Name:WxH also sets its height, +N leaves N units of space and a line with only space moves the next row down.
+// Every scancode may appear at most once. Returns std::nullopt and the error with its line number if invalid.
+std::optional<KeyboardLayout> compileLayout(std::string name, std::istream& source, std::string& error);
+
+// The layout is named after the file
+std::optional<KeyboardLayout> loadLayout(const std::filesystem::path& path, std::string& error);
+
+// Compiled from resources/layouts at build time
+const std::vector<KeyboardLayout>& getBuiltinLayouts();
@@ -1,118 +1,250 @@
 #include "KeyboardView.hpp"
 
-#include <unordered_set>
+#include <algorithm>
 
-#include <cassert>
 #include <cmath>
 
-KeyboardView::KeyboardView(const sf::Font& font) :
-m_triangles{sf::PrimitiveType::Triangles, sf::Keyboard::ScancodeCount * 6},
-m_labels(sf::Keyboard::ScancodeCount, sf::Text{font, "", 16})
+namespace
 {
-    m_bloatFactor.fill(1.f);
+sf::Color mix(const sf::Color& from, const sf::Color& to, float ratio)
+{
+    const auto channel = [ratio](std::uint8_t a, std::uint8_t b)
+    { return static_cast<std::uint8_t>(static_cast<float>(a) + static_cast<float>(b - a) * ratio); };
+
+    return {channel(from.r, to.r), channel(from.g, to.g), channel(from.b, to.b)};
+}
+
+constexpr auto square = std::array<sf::Vector2f, 4>{{
+    {0.f, 0.f},
+    {1.f, 0.f},
+    {1.f, 1.f},
+    {0.f, 1.f},
+}};
+
+// Two triangles of a rectangle with the corners of square
+constexpr auto indexes = std::array<std::size_t, 6>{0, 1, 3, 3, 1, 2};
+
+sf::FloatRect getBounds(const std::vector<KeyboardLayout::Cell>& cells)
+{
+    auto end = sf::Vector2f{};
+    for (const auto& cell : cells)
+        end = {std::max(end.x, cell.rect.position.x + cell.rect.size.x),
+               std::max(end.y, cell.rect.position.y + cell.rect.size.y)};
+
+    return {{}, end};
+}
+
+} // namespace
+
+KeyboardState::KeyboardState(const KeyboardLayout& layout)
+{
+    for (const auto& cell : layout.cells)
+        if (cell.scancode != sf::Keyboard::Scan::Unknown)
+            m_shown.set(cell.scancode);
+}
+
+void KeyboardState::handle(const sf::Event& event)
+{
+    auto scancode = sf::Keyboard::Scan::Unknown;
+    auto bloat    = 1.f;
+    if (const auto* keyPressedEvent = event.getIf<sf::Event::KeyPressed>())
+    {
+        scancode = keyPressedEvent->scancode;
+        bloat    = 0.5f;
+    }
+    else if (const auto* keyReleasedEvent = event.getIf<sf::Event::KeyReleased>())
+    {
+        scancode = keyReleasedEvent->scancode;
+        bloat    = 1.5f;
+    }
+
+    if (scancode == sf::Keyboard::Scan::Unknown)
+        return;
+
+    auto& key = keys[scancode];
+    key.bloat = bloat;
+    ++key.bloats;
+    ++revision;
+}
+
+void KeyboardState::update()
+{
+    auto sampled = EnumBitset<sf::Keyboard::Scancode>{};
+    for (auto scancode : m_shown)
+        sampled.set(scancode, sf::Keyboard::isKeyPressed(scancode));
+
+    if (sampled == pressed)
+        return;
+
+    pressed = sampled;
+    ++revision;
+}
+
+void KeyboardState::mark(sf::Keyboard::Scancode scancode, const sf::Color& color, sf::Time duration)
+{
+    if (scancode == sf::Keyboard::Scan::Unknown)
+        return;
+
+    auto& key        = keys[scancode];
+    key.markColor    = color;
+    key.markDuration = duration;
+    ++key.marks;
+    ++revision;
+}
+
+void KeyboardState::setHeat(sf::Keyboard::Scancode scancode, float heat)
+{
+    heat = std::clamp(heat, 0.f, 1.f);
+    if (scancode == sf::Keyboard::Scan::Unknown || keys[scancode].heat == heat)
+        return;
 
-    // Check all the scancodes are in the matrix exactly once
+    keys[scancode].heat = heat;
+    ++revision;
+}
+
+KeyboardView::KeyboardView(Animator& animator, const sf::Font& font, const KeyboardLayout& layout) :
+m_animator{animator},
+m_cells{layout.cells},
+m_triangles{sf::PrimitiveType::Triangles, layout.cells.size() * 6},
+m_frames{sf::PrimitiveType::Triangles, layout.cells.size() * frameVertices},
+m_labelCache{getBounds(layout.cells)}
+{
+    m_labels.texts.assign(layout.cells.size(), sf::Text{font, "", 16});
+
+    for (std::size_t i = 0; i < m_cells.size(); ++i)
+    {
+        auto& key = m_keys[m_cells[i].scancode];
+        key.cell  = static_cast<std::uint16_t>(i);
+        updateCell(key);
+
+        // The marks don't move, only their color changes
+        const auto& [position, size] = m_cells[i].rect;
+
+        const auto sides = std::array<sf::FloatRect, 4>{{
+            {position, {size.x, frameThickness}},
+            {position + sf::Vector2f{0.f, size.y - frameThickness}, {size.x, frameThickness}},
+            {position, {frameThickness, size.y}},
+            {position + sf::Vector2f{size.x - frameThickness, 0.f}, {frameThickness, size.y}},
+        }};
+        for (std::size_t side = 0; side < sides.size(); ++side)
+            for (std::size_t corner = 0; corner < 6; ++corner)
+                m_frames[i * frameVertices + side * 6 + corner] = {
+                    sides[side].position + sf::Vector2f{sides[side].size.x * square[indexes[corner]].x,
+                                                        sides[side].size.y * square[indexes[corner]].y},
+                    sf::Color::Transparent};
+    }
+
+    // Fit the labels into their slots once
+    for (std::size_t i = 0; i < m_cells.size(); ++i)
     {
-        auto scancodesInMatrix = std::unordered_set<sf::Keyboard::Scancode>{};
-        for (const auto& [cells, marginBottom] : matrix)
+        const auto& cell  = m_cells[i];
+        auto&       label = m_labels.texts[i];
+        label.setString(sf::Keyboard::getDescription(cell.scancode));
+        label.setPosition(cell.labelCenter);
+
+        if (cell.labelWidth < label.getLocalBounds().size.x)
         {
-            for (const auto& [scancode, size, marginRight] : cells)
-            {
-                assert(scancodesInMatrix.count(scancode) == 0);
-                scancodesInMatrix.insert(scancode);
-            }
+            auto string = label.getString();
+            string.replace(" ", "\n");
+            label.setString(string);
         }
-        assert(scancodesInMatrix.size() == sf::Keyboard::ScancodeCount);
+        while (cell.labelWidth < label.getLocalBounds().size.x && label.getCharacterSize() > 8)
+            label.setCharacterSize(label.getCharacterSize() - 2);
+
+        const auto bounds = label.getLocalBounds();
+        label.setOrigin(sf::Vector2f{std::round(bounds.position.x + bounds.size.x / 2.f),
+                                     std::round(static_cast<float>(label.getCharacterSize()) / 2.f)});
     }
+}
+
+void KeyboardView::apply(const KeyboardState& state)
+{
+    if (m_revision == state.revision)
+        return;
+    m_revision = state.revision;
 
-    // Initialize labels
-    auto position = sf::Vector2f{};
-    for (const auto& [cells, marginBottom] : matrix)
+    for (const auto& cell : m_cells)
     {
-        for (const auto& [scancode, size, marginRight] : cells)
+        const auto& from = state.keys[cell.scancode];
+        auto&       key  = m_keys[cell.scancode];
+
+        if (key.heat != from.heat || key.pressed != state.pressed[cell.scancode])
+        {
+            key.heat    = from.heat;
+            key.pressed = state.pressed[cell.scancode];
+            updateCell(key);
+        }
+
+        if (key.bloats != from.bloats)
         {
-            auto& label = m_labels[static_cast<std::size_t>(scancode)];
-            label.setString(sf::Keyboard::getDescription(scancode));
-            label.setPosition(position + size / 2.f);
-
-            if (size.x < label.getLocalBounds().size.x + padding * 2.f + 2.f)
-            {
-                auto string = label.getString();
-                string.replace(" ", "\n");
-                label.setString(string);
-            }
-            while (size.x < label.getLocalBounds().size.x + padding * 2.f + 2.f)
-                label.setCharacterSize(label.getCharacterSize() - 2);
-
-            const auto bounds = label.getLocalBounds();
-            label.setOrigin(sf::Vector2f{std::round(bounds.position.x + bounds.size.x / 2.f),
-                                         std::round(static_cast<float>(label.getCharacterSize()) / 2.f)});
-
-            position.x += size.x + marginRight;
+            key.bloats      = from.bloats;
+            key.bloatFactor = from.bloat;
+            key.bloatStart  = from.bloat;
+            m_animator.start(*this, static_cast<std::size_t>(cell.scancode), bloatDuration);
+        }
+
+        if (key.marks != from.marks)
+        {
+            key.marks        = from.marks;
+            key.markColor    = from.markColor;
+            key.markDuration = from.markDuration;
+            m_animator.start(*this, markChannel + static_cast<std::size_t>(cell.scancode), from.markDuration);
         }
-        position.x = 0.f;
-        position.y += keySize + marginBottom;
     }
 }
 
-void KeyboardView::handle(const sf::Event& event)
+void KeyboardView::animate(std::size_t channel, float progress)
 {
-    if (const auto* keyPressedEvent = event.getIf<sf::Event::KeyPressed>())
+    if (channel < markChannel)
     {
-        if (keyPressedEvent->scancode != sf::Keyboard::Scan::Unknown)
-            m_bloatFactor[static_cast<std::size_t>(keyPressedEvent->scancode)] = 0.5f;
+        auto& key       = m_keys[static_cast<sf::Keyboard::Scancode>(channel)];
+        key.bloatFactor = key.bloatStart + (1.f - key.bloatStart) * progress;
+        updateCell(key);
     }
-    else if (const auto* keyReleasedEvent = event.getIf<sf::Event::KeyReleased>())
+    else
     {
-        if (keyReleasedEvent->scancode != sf::Keyboard::Scan::Unknown)
-            m_bloatFactor[static_cast<std::size_t>(keyReleasedEvent->scancode)] = 1.5f;
+        // Fades out during the last second
+        const auto& key       = m_keys[static_cast<sf::Keyboard::Scancode>(channel - markChannel)];
+        const auto  remaining = key.markDuration * (1.f - progress);
+        updateMark(key, static_cast<std::uint8_t>(255.f * std::min(1.f, remaining / sf::seconds(1.f))));
     }
 }
 
-void KeyboardView::update(sf::Time frameTime)
+void KeyboardView::updateCell(const Key& key)
 {
-    const auto transitionDuration = sf::seconds(0.3f);
-    for (auto& zoom : m_bloatFactor)
-    {
-        const auto absBloatChange = std::min(std::abs(zoom - 1.f), frameTime / transitionDuration);
-        zoom += 1.f < zoom ? -absBloatChange : absBloatChange;
-    }
+    const auto& rect = m_cells[key.cell].rect;
 
-    const auto square = std::vector<sf::Vector2f>{
-        {0.f, 0.f},
-        {1.f, 0.f},
-        {1.f, 1.f},
-        {0.f, 1.f},
-    };
-    constexpr auto indexes = std::array{0, 1, 3, 3, 1, 2};
-
-    auto position = sf::Vector2f{};
-    for (const auto& [cells, marginBottom] : matrix)
+    const auto pad   = KeyboardLayout::padding - KeyboardLayout::padding * (key.bloatFactor - 1.f);
+    const auto color = key.pressed ? sf::Color{96, 96, 96} : mix({48, 48, 48}, {192, 48, 32}, key.heat);
+    for (std::size_t index = 0; index < 6; ++index)
     {
-        for (const auto& [scancode, size, marginRight] : cells)
-        {
-            const auto pressed = sf::Keyboard::isKeyPressed(scancode);
-            const auto pad     = padding - padding * (m_bloatFactor[static_cast<std::size_t>(scancode)] - 1.f);
-            for (const auto index : {0, 1, 2, 3, 4, 5})
-            {
-                const auto& corner = square[indexes[index]];
-                auto&       vertex = m_triangles[6 * static_cast<int>(scancode) + index];
-
-                vertex.position = position + sf::Vector2f{pad + (size.x - 2.f * pad) * corner.x,
-                                                          pad + (size.y - 2.f * pad) * corner.y};
-                vertex.color    = pressed ? sf::Color{96, 96, 96} : sf::Color{48, 48, 48};
-            }
-            position.x += size.x + marginRight;
-        }
-        position.x = 0.f;
-        position.y += keySize + marginBottom;
+        const auto& corner = square[indexes[index]];
+        auto&       vertex = m_triangles[m_cells[key.cell].vertexOffset + index];
+
+        vertex.position = rect.position + sf::Vector2f{pad + (rect.size.x - 2.f * pad) * corner.x,
+                                                       pad + (rect.size.y - 2.f * pad) * corner.y};
+        vertex.color    = color;
     }
 }
 
+void KeyboardView::updateMark(const Key& key, std::uint8_t alpha)
+{
+    auto color = key.markColor;
+    color.a    = alpha;
+    for (std::size_t i = 0; i < frameVertices; ++i)
+        m_frames[key.cell * frameVertices + i].color = color;
+}
+
 void KeyboardView::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
     states.transform *= getTransform();
     target.draw(m_triangles, states);
-    for (const auto& label : m_labels)
-        target.draw(label, states);
+    target.draw(m_frames, states);
+    m_labelCache.draw(target, states, m_labels, 0);
+}
+
+void KeyboardView::Labels::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    for (const auto& text : texts)
+        target.draw(text, states);
 }
@@ -0,0 +1,68 @@
+#include "LayerCache.hpp"
+
+#include <SFML/Graphics/BlendMode.hpp>
+#include <SFML/Graphics/View.hpp>
+
+#include <iostream>
+
+#include <cmath>
+
+namespace
+{
+// The texture holds colors already multiplied by their alpha, as drawing onto a transparent texture leaves them
+const auto premultipliedAlpha = sf::BlendMode{sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha};
+
+// Whole pixels, so that the texture is copied without filtering
+sf::FloatRect snap(const sf::FloatRect& area)
+{
+    const auto end      = area.position + area.size;
+    const auto position = sf::Vector2f{std::floor(area.position.x), std::floor(area.position.y)};
+
+    return {position, sf::Vector2f{std::ceil(end.x), std::ceil(end.y)} - position};
+}
+
+} // namespace
+
+LayerCache::LayerCache(const sf::FloatRect& area) :
+m_valid{m_texture.resize(sf::Vector2u{snap(area).size})},
+m_area{snap(area)}
+{
+    if (!m_valid)
+    {
+        std::cout << "Error: cannot create a texture of " << m_area.size.x << "x" << m_area.size.y
+                  << " to cache a layer, drawing it directly\n";
+        return;
+    }
+
+    m_texture.setView(sf::View{m_area});
+
+    const auto& [position, size] = m_area;
+    const auto corner            = [&](float x, float y)
+    { return sf::Vertex{position + sf::Vector2f{size.x * x, size.y * y}, sf::Color::White, {size.x * x, size.y * y}}; };
+    m_quad = {corner(0.f, 0.f), corner(1.f, 0.f), corner(0.f, 1.f),
+              corner(0.f, 1.f), corner(1.f, 0.f), corner(1.f, 1.f)};
+}
+
+void LayerCache::draw(sf::RenderTarget&   target,
+                      sf::RenderStates    states,
+                      const sf::Drawable& content,
+                      std::uint32_t       revision)
+{
+    if (!m_valid)
+    {
+        target.draw(content, states);
+        return;
+    }
+
+    if (m_revision != revision)
+    {
+        m_revision = revision;
+        m_texture.clear(sf::Color::Transparent);
+        m_texture.draw(content);
+        m_texture.display();
+    }
+
+    states.texture   = &m_texture.getTexture();
+    states.blendMode = premultipliedAlpha;
+    target.draw(m_quad.data(), m_quad.size(), sf::PrimitiveType::Triangles, states);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+
+#include <array>
+#include <optional>
+
+#include <cstdint>
+
+// Keeps what a drawable drew in a texture of its own and draws the texture as a single quad until the drawable
+// changes, so that a frame only costs a layout and glyph draws for the parts which changed
+class LayerCache
+{
+public:
+    // Area the content is drawn in, in the coordinates of the states the cache is drawn with, whatever falls outside
+    // is clipped. The content is drawn directly if the texture can't be created.
+    explicit LayerCache(const sf::FloatRect& area);
+
+    // The content is only drawn again into the texture if its revision differs from the one drawn last
+    void draw(sf::RenderTarget& target, sf::RenderStates states, const sf::Drawable& content, std::uint32_t revision);
+
+private:
+    sf::RenderTexture            m_texture;
+    bool                         m_valid;
+    sf::FloatRect                m_area;
+    std::array<sf::Vertex, 6>    m_quad;
+    std::optional<std::uint32_t> m_revision; // of the content in the texture
+};
@@ -0,0 +1,188 @@
+#include "MouseAnalyzer.hpp"
+
+#include <algorithm>
+
+#include <cmath>
+
+namespace
+{
+constexpr auto window = sf::seconds(1.f);
+
+// Gaps longer than this many median intervals are pauses in the motion rather than dropped reports
+constexpr auto idleFactor = 4.f;
+
+constexpr auto movedColor    = sf::Color::Yellow;
+constexpr auto movedRawColor = sf::Color::Cyan;
+
+} // namespace
+
+MouseAnalyzer::MouseAnalyzer(FrameArena& arena) : m_arena{arena}
+{
+    m_intervals.reserve(capacity);
+}
+
+bool MouseAnalyzer::record(const sf::Event& event, sf::Time timestamp)
+{
+    auto* stream = event.is<sf::Event::MouseMovedRaw>() ? &m_movedRaw
+                   : event.is<sf::Event::MouseMoved>()  ? &m_moved
+                                                        : nullptr;
+    if (!stream)
+        return false;
+
+    stream->timestamps[stream->count++ % capacity] = timestamp.asMicroseconds();
+    return true;
+}
+
+bool MouseAnalyzer::update(sf::Time now, State& state)
+{
+    m_movedStatistics    = m_moved.computeStatistics(now - window, now, m_intervals);
+    m_movedRawStatistics = m_movedRaw.computeStatistics(now - window, now, m_intervals);
+
+    m_movedHistory[m_historyIndex]    = m_movedStatistics.rate;
+    m_movedRawHistory[m_historyIndex] = m_movedRawStatistics.rate;
+    m_historyIndex                    = (m_historyIndex + 1) % historySize;
+
+    state.transform = getTransform();
+    for (std::size_t i = 0; i < historySize; ++i)
+    {
+        const auto index       = (m_historyIndex + i) % historySize;
+        state.movedRates[i]    = m_movedHistory[index];
+        state.movedRawRates[i] = m_movedRawHistory[index];
+    }
+
+    auto text = TextBuilder{m_arena};
+    text += "Mouse Motion\n\n";
+    describe(text, "MouseMovedRaw", m_movedRawStatistics);
+    describe(text, "MouseMoved", m_movedStatistics);
+    text.copyTo(state.text);
+
+    if (now - m_lastSummary < window)
+        return false;
+
+    m_lastSummary = now;
+    if (m_movedStatistics.reports == 0 && m_movedRawStatistics.reports == 0)
+        return false;
+
+    text += "\n";
+    text.copyTo(m_summary);
+    return true;
+}
+
+const sf::String& MouseAnalyzer::getSummary() const
+{
+    return m_summary;
+}
+
+void MouseAnalyzer::describe(TextBuilder& text, const char* name, const Statistics& statistics)
+{
+    text += name;
+    text += ":\t";
+    text += std::lround(statistics.rate);
+    text += " Hz\t";
+    text += statistics.reports;
+    text += " reports\tinterval ";
+    text += statistics.interval.asMicroseconds();
+    text += " us\tjitter ";
+    text += statistics.jitter.asMicroseconds();
+    text += " us\tdropped ";
+    text += statistics.dropped;
+    text += "\n";
+}
+
+MouseAnalyzer::Statistics MouseAnalyzer::Stream::computeStatistics(sf::Time                   from,
+                                                                   sf::Time                   to,
+                                                                   std::vector<std::int64_t>& intervals) const
+{
+    auto statistics = Statistics{};
+
+    // Walk back from the newest report until the start of the window
+    intervals.clear();
+    const auto oldest = count < capacity ? 0 : count - capacity;
+    auto       next   = to.asMicroseconds();
+    for (auto i = count; i > oldest; --i)
+    {
+        const auto timestamp = timestamps[(i - 1) % capacity];
+        if (timestamp < from.asMicroseconds())
+            break;
+
+        if (statistics.reports++ != 0)
+            intervals.push_back(next - timestamp);
+        next = timestamp;
+    }
+    if (intervals.empty())
+        return statistics;
+
+    const auto middle = intervals.begin() + static_cast<std::ptrdiff_t>(intervals.size() / 2);
+    std::nth_element(intervals.begin(), middle, intervals.end());
+    const auto median = std::max(std::int64_t{1}, *middle);
+
+    // Only the intervals while the mouse is moving count towards the rate and the jitter
+    auto sum        = 0.0;
+    auto squaredSum = 0.0;
+    auto n          = 0;
+    for (const auto interval : intervals)
+    {
+        const auto ratio = static_cast<float>(interval) / static_cast<float>(median);
+        if (idleFactor < ratio)
+            continue;
+
+        if (1.5f < ratio)
+            statistics.dropped += static_cast<std::size_t>(std::lround(ratio)) - 1;
+
+        sum += static_cast<double>(interval);
+        squaredSum += static_cast<double>(interval) * static_cast<double>(interval);
+        ++n;
+    }
+
+    const auto mean     = sum / n;
+    statistics.rate     = static_cast<float>(1'000'000.0 / std::max(mean, 1.0));
+    statistics.interval = sf::microseconds(median);
+    statistics.jitter   = sf::microseconds(std::llround(std::sqrt(std::max(0.0, squaredSum / n - mean * mean))));
+
+    return statistics;
+}
+
+MouseAnalyzerView::MouseAnalyzerView(const sf::Font& font) :
+m_text{font, "", 14},
+m_background{sf::PrimitiveType::TriangleStrip, 4},
+m_movedGraph{sf::PrimitiveType::LineStrip, MouseAnalyzer::historySize},
+m_movedRawGraph{sf::PrimitiveType::LineStrip, MouseAnalyzer::historySize}
+{
+    m_background[0] = {{0.f, graphTop}, sf::Color{32, 32, 32}};
+    m_background[1] = {{graphSize.x, graphTop}, sf::Color{32, 32, 32}};
+    m_background[2] = {{0.f, graphTop + graphSize.y}, sf::Color{32, 32, 32}};
+    m_background[3] = {{graphSize.x, graphTop + graphSize.y}, sf::Color{32, 32, 32}};
+
+    for (std::size_t i = 0; i < MouseAnalyzer::historySize; ++i)
+    {
+        m_movedGraph[i].color    = movedColor;
+        m_movedRawGraph[i].color = movedRawColor;
+    }
+
+    apply({});
+}
+
+void MouseAnalyzerView::apply(const MouseAnalyzer::State& state)
+{
+    m_transform = state.transform;
+    setText(m_text, state.text);
+
+    // Oldest point on the left, newest on the right
+    const auto y = [](float rate) { return graphTop + graphSize.y * (1.f - std::min(rate / graphMaxRate, 1.f)); };
+    for (std::size_t i = 0; i < MouseAnalyzer::historySize; ++i)
+    {
+        const auto x = graphSize.x * static_cast<float>(i) / static_cast<float>(MouseAnalyzer::historySize - 1);
+
+        m_movedGraph[i].position    = {x, y(state.movedRates[i])};
+        m_movedRawGraph[i].position = {x, y(state.movedRawRates[i])};
+    }
+}
+
+void MouseAnalyzerView::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    states.transform *= m_transform;
+    target.draw(m_background, states);
+    target.draw(m_movedGraph, states);
+    target.draw(m_movedRawGraph, states);
+    target.draw(m_text, states);
+}
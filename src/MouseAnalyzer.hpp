@@ -0,0 +1,98 @@
+#pragma once
+
+#include "FrameArena.hpp"
+#include "TextBuilder.hpp"
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Transformable.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+
+#include <SFML/Window/Event.hpp>
+
+#include <SFML/System/String.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <cstdint>
+
+// Estimates the report rate, jitter and dropped reports of the mouse from the timestamps of its motion events
+class MouseAnalyzer : public sf::Transformable
+{
+public:
+    static constexpr std::size_t historySize = 256; // points of the rolling graph, one per frame
+
+    // What the view draws
+    struct State
+    {
+        sf::Transform                  transform;
+        std::u32string                 text;
+        std::array<float, historySize> movedRates{}, movedRawRates{}; // Hz, oldest first
+    };
+
+    explicit MouseAnalyzer(FrameArena& arena);
+
+    // Returns false if the event is not a motion event, motion events are only stored
+    bool record(const sf::Event& event, sf::Time timestamp);
+
+    // Returns true when a new one second summary is available
+    bool update(sf::Time now, State& state);
+    const sf::String& getSummary() const;
+
+private:
+    static constexpr std::size_t capacity = 4096; // reports kept per stream, 4 seconds at 1000 Hz
+
+    struct Statistics
+    {
+        std::size_t reports = 0;
+        float       rate    = 0.f; // Hz
+        sf::Time    interval;      // median
+        sf::Time    jitter;        // standard deviation of the intervals
+        std::size_t dropped = 0;
+    };
+
+    struct Stream
+    {
+        Statistics computeStatistics(sf::Time from, sf::Time to, std::vector<std::int64_t>& intervals) const;
+
+        std::array<std::int64_t, capacity> timestamps{}; // microseconds
+        std::size_t                        count = 0;
+    };
+
+    static void describe(TextBuilder& text, const char* name, const Statistics& statistics);
+
+    FrameArena&               m_arena;
+    Stream                    m_moved, m_movedRaw;
+    Statistics                m_movedStatistics, m_movedRawStatistics;
+    std::vector<std::int64_t> m_intervals; // scratch memory to compute the statistics without allocating
+    sf::Time                  m_lastSummary;
+    sf::String                m_summary;
+
+    std::array<float, historySize> m_movedHistory{}, m_movedRawHistory{};
+    std::size_t                    m_historyIndex = 0;
+};
+
+// Draws the state of a mouse analyzer, the text and a graph of the rates
+class MouseAnalyzerView : public sf::Drawable
+{
+public:
+    explicit MouseAnalyzerView(const sf::Font& font);
+
+    void apply(const MouseAnalyzer::State& state);
+
+private:
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    static constexpr auto graphTop     = 90.f; // below the five text lines
+    static constexpr auto graphSize    = sf::Vector2f{512.f, 160.f};
+    static constexpr auto graphMaxRate = 1000.f;
+
+    sf::Transform   m_transform;
+    sf::Text        m_text;
+    sf::VertexArray m_background, m_movedGraph, m_movedRawGraph;
+};
@@ -0,0 +1,454 @@
+#include "PatternMatcher.hpp"
+
+#include "strings.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <cstdlib>
+
+namespace
+{
+constexpr auto defaultWithin = sf::seconds(1);
+constexpr auto noPattern     = ~std::size_t{0};
+
+std::optional<sf::Keyboard::Scancode> parseScancode(const std::string& name)
+{
+    const auto prefixed = name.compare(0, 6, "Scan::") == 0 ? name : "Scan::" + name;
+    for (auto scancode : scancodes)
+        if (scancodeIdentifier(scancode) == prefixed)
+            return scancode;
+
+    return std::nullopt;
+}
+
+std::optional<sf::Keyboard::Key> parseKey(const std::string& name)
+{
+    for (auto key : keys)
+        if (keyIdentifier(key) == name)
+            return key;
+
+    return std::nullopt;
+}
+
+// Returns false unless the whole text is a number of milliseconds between 1 and an hour
+bool parseMilliseconds(const std::string& text, sf::Time& time)
+{
+    char*      end          = nullptr;
+    const auto milliseconds = std::strtol(text.c_str(), &end, 10);
+    time                    = sf::milliseconds(static_cast<std::int32_t>(milliseconds));
+    return !text.empty() && end == text.c_str() + text.size() && 1 <= milliseconds && milliseconds <= 3600000;
+}
+
+std::string trim(const std::string& text)
+{
+    const auto begin = text.find_first_not_of(" \t");
+    const auto end   = text.find_last_not_of(" \t");
+    return begin == std::string::npos ? std::string{} : text.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+std::size_t Chord::size() const
+{
+    return scancodes.count() + keys.count();
+}
+
+std::optional<std::vector<Pattern>> compilePatterns(std::istream& source, std::string& error)
+{
+    auto patterns = std::vector<Pattern>{};
+
+    auto lineNumber = 0;
+    for (auto line = std::string{}; std::getline(source, line);)
+    {
+        ++lineNumber;
+        const auto fail = [&](const std::string& message)
+        {
+            error = "line " + std::to_string(lineNumber) + ": " + message;
+            return std::nullopt;
+        };
+
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+
+        const auto colon = line.find(':');
+        auto       name  = trim(line.substr(0, colon));
+        if (colon == std::string::npos || name.empty())
+            return fail("missing pattern name");
+        if (name.find_first_of("\"\\") != std::string::npos)
+            return fail("pattern name " + name + " contains a quote or a backslash");
+
+        auto pattern = Pattern{std::move(name), {}, defaultWithin, sf::Time::Zero};
+        auto tokens  = std::istringstream{line.substr(colon + 1)};
+        for (auto token = std::string{}; tokens >> token;)
+        {
+            if (token == "within" || token == "chord")
+            {
+                auto& time  = token == "within" ? pattern.within : pattern.chordWithin;
+                auto  value = std::string{};
+                if (!(tokens >> value) || !parseMilliseconds(value, time))
+                    return fail("invalid " + token + " time " + value);
+                continue;
+            }
+
+            auto& chord = pattern.steps.emplace_back();
+            for (std::size_t begin = 0, end = 0; begin <= token.size(); begin = end + 1)
+            {
+                end                = std::min(token.find('+', begin), token.size());
+                const auto keyName = token.substr(begin, end - begin);
+                if (keyName.compare(0, 5, "Key::") == 0)
+                {
+                    const auto key = parseKey(keyName);
+                    if (!key)
+                        return fail("unknown key " + keyName);
+                    if (chord.keys[*key])
+                        return fail(keyName + " appears twice in " + token);
+                    chord.keys.set(*key);
+                }
+                else
+                {
+                    const auto scancode = parseScancode(keyName);
+                    if (!scancode)
+                        return fail("unknown scancode " + keyName);
+                    if (chord.scancodes[*scancode])
+                        return fail(keyName + " appears twice in " + token);
+                    chord.scancodes.set(*scancode);
+                }
+            }
+        }
+
+        if (pattern.steps.empty())
+            return fail("pattern " + pattern.name + " has no steps");
+        if (pattern.steps.size() > 64)
+            return fail("pattern " + pattern.name + " has more than 64 steps");
+
+        patterns.push_back(std::move(pattern));
+    }
+
+    if (patterns.empty())
+    {
+        error = "no patterns";
+        return std::nullopt;
+    }
+
+    return patterns;
+}
+
+std::optional<std::vector<Pattern>> loadPatterns(const std::filesystem::path& path, std::string& error)
+{
+    auto file = std::ifstream{path};
+    if (!file)
+    {
+        error = "cannot open " + path.string();
+        return std::nullopt;
+    }
+
+    auto patterns = compilePatterns(file, error);
+    if (!patterns)
+        error = path.string() + ", " + error;
+
+    return patterns;
+}
+
+PatternMatcher::PatternMatcher(std::vector<Pattern> patterns) :
+m_patterns{std::move(patterns)},
+m_statistics(m_patterns.size())
+{
+    // Chords shared by several patterns are one symbol, with the shortest time limit
+    auto sequences = std::vector<std::vector<std::size_t>>{};
+    auto maxLength = std::size_t{1};
+    for (std::size_t p = 0; p < m_patterns.size(); ++p)
+    {
+        const auto& pattern  = m_patterns[p];
+        auto&       sequence = sequences.emplace_back();
+        for (const auto& step : pattern.steps)
+        {
+            const auto isSame = [&](const Chord& chord)
+            { return chord.scancodes == step.scancodes && chord.keys == step.keys; };
+            const auto index = static_cast<std::size_t>(
+                std::find_if(m_chords.begin(), m_chords.end(), isSame) - m_chords.begin());
+
+            if (index == m_chords.size())
+            {
+                m_chords.push_back(step);
+                m_chordWithin.push_back(pattern.chordWithin);
+                m_chordPattern.push_back(p);
+                for (auto scancode : step.scancodes)
+                    m_chordsByScancode[scancode].push_back(static_cast<std::uint16_t>(index));
+                for (auto key : step.keys)
+                    m_chordsByKey[key].push_back(static_cast<std::uint16_t>(index));
+            }
+            else if (pattern.chordWithin != sf::Time::Zero)
+            {
+                auto& within = m_chordWithin[index];
+                within       = within == sf::Time::Zero ? pattern.chordWithin : std::min(within, pattern.chordWithin);
+            }
+
+            sequence.push_back(index + 1);
+        }
+        maxLength = std::max(maxLength, sequence.size());
+    }
+    m_symbolCount = m_chords.size() + 1;
+
+    // Trie of the sequences
+    constexpr auto none     = ~State{0};
+    auto           ends     = std::vector<std::vector<std::size_t>>{};
+    const auto     addState = [&](std::size_t depth)
+    {
+        m_transitions.resize(m_transitions.size() + m_symbolCount, none);
+        m_depth.push_back(static_cast<std::uint16_t>(depth));
+        m_within.push_back(sf::Time::Zero);
+        m_partOf.push_back(noPattern);
+        ends.emplace_back();
+        return static_cast<State>(m_depth.size() - 1);
+    };
+    addState(0);
+
+    for (std::size_t p = 0; p < m_patterns.size(); ++p)
+    {
+        auto state = root;
+        for (std::size_t i = 0; i < sequences[p].size(); ++i)
+        {
+            m_within[state] = std::max(m_within[state], m_patterns[p].within);
+            if (m_partOf[state] == noPattern)
+                m_partOf[state] = p;
+
+            const auto transition = state * m_symbolCount + sequences[p][i];
+            if (m_transitions[transition] == none)
+            {
+                const auto next           = addState(i + 1);
+                m_transitions[transition] = next;
+            }
+            state = m_transitions[transition];
+        }
+        ends[state].push_back(p);
+    }
+
+    // Failure links, folded into the transitions so that every press is a single lookup
+    auto fail  = std::vector<State>(m_depth.size(), root);
+    auto queue = std::vector<State>{};
+    queue.reserve(m_depth.size());
+    for (std::size_t symbol = 0; symbol < m_symbolCount; ++symbol)
+    {
+        auto& next = m_transitions[symbol];
+        if (next == none)
+            next = root;
+        else
+            queue.push_back(next);
+    }
+
+    // Breadth first, so the state a failure link leads to is always complete
+    for (std::size_t i = 0; i < queue.size(); ++i)
+    {
+        const auto state = queue[i];
+        if (fail[state] != root)
+        {
+            ends[state].insert(ends[state].end(), ends[fail[state]].begin(), ends[fail[state]].end());
+            m_within[state] = std::max(m_within[state], m_within[fail[state]]);
+        }
+
+        for (std::size_t symbol = 0; symbol < m_symbolCount; ++symbol)
+        {
+            auto&      next     = m_transitions[state * m_symbolCount + symbol];
+            const auto fallback = m_transitions[fail[state] * m_symbolCount + symbol];
+            if (next == none)
+            {
+                next = fallback;
+            }
+            else
+            {
+                fail[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    auto maxOutputs = std::size_t{0};
+    for (const auto& patternsEnding : ends)
+    {
+        m_outputBegin.push_back(static_cast<std::uint32_t>(m_outputs.size()));
+        m_outputs.insert(m_outputs.end(), patternsEnding.begin(), patternsEnding.end());
+        maxOutputs = std::max(maxOutputs, patternsEnding.size());
+    }
+    m_outputBegin.push_back(static_cast<std::uint32_t>(m_outputs.size()));
+
+    // Nothing is allocated while handling events
+    m_stepTimes.resize(maxLength);
+    m_results.reserve(maxOutputs + 3);
+}
+
+const std::vector<PatternMatcher::Result>& PatternMatcher::handle(const sf::Event& event, sf::Time timestamp)
+{
+    m_results.clear();
+
+    if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>())
+    {
+        const auto hasScancode = keyPressed->scancode != sf::Keyboard::Scan::Unknown;
+        const auto hasCode     = keyPressed->code != sf::Keyboard::Key::Unknown;
+
+        // Autorepeat doesn't count as a step
+        const auto repeated = hasScancode ? m_heldScancodes[keyPressed->scancode]
+                                          : hasCode && m_heldKeys[keyPressed->code];
+        if (repeated)
+            return m_results;
+
+        if (hasScancode)
+        {
+            m_heldScancodes.set(keyPressed->scancode);
+            m_scancodePressedAt[keyPressed->scancode] = timestamp;
+        }
+        if (hasCode)
+        {
+            m_heldKeys.set(keyPressed->code);
+            m_keyPressedAt[keyPressed->code] = timestamp;
+        }
+
+        if (const auto symbol = completedChord(keyPressed->scancode, keyPressed->code, timestamp))
+            advance(*symbol, timestamp);
+    }
+    else if (const auto* keyReleased = event.getIf<sf::Event::KeyReleased>())
+    {
+        if (keyReleased->scancode != sf::Keyboard::Scan::Unknown)
+            m_heldScancodes.reset(keyReleased->scancode);
+        if (keyReleased->code != sf::Keyboard::Key::Unknown)
+            m_heldKeys.reset(keyReleased->code);
+    }
+    else if (event.is<sf::Event::FocusLost>())
+    {
+        // Releases are not reported to unfocused windows
+        m_heldScancodes.reset();
+        m_heldKeys.reset();
+        m_state = root;
+    }
+
+    return m_results;
+}
+
+const Pattern& PatternMatcher::getPattern(std::size_t pattern) const
+{
+    return m_patterns[pattern];
+}
+
+std::size_t PatternMatcher::getPatternCount() const
+{
+    return m_patterns.size();
+}
+
+void PatternMatcher::print(std::ostream& os) const
+{
+    os << "\tPatterns\n\n";
+    for (std::size_t p = 0; p < m_patterns.size(); ++p)
+    {
+        const auto& statistics = m_statistics[p];
+        os << m_patterns[p].name << ": " << statistics.matches << " matches, " << statistics.nearMisses
+           << " near misses";
+        if (statistics.matches != 0)
+            os << ", fastest in " << statistics.fastest.asMilliseconds() << " ms";
+        os << '\n';
+    }
+    os << '\n';
+}
+
+std::optional<std::size_t> PatternMatcher::completedChord(sf::Keyboard::Scancode scancode,
+                                                          sf::Keyboard::Key      code,
+                                                          sf::Time               timestamp)
+{
+    static const auto noChords = std::vector<std::uint16_t>{};
+
+    const auto& byScancode = scancode != sf::Keyboard::Scan::Unknown ? m_chordsByScancode[scancode] : noChords;
+    const auto& byKey      = code != sf::Keyboard::Key::Unknown ? m_chordsByKey[code] : noChords;
+
+    // Keys in no pattern interrupt the sequences
+    if (byScancode.empty() && byKey.empty())
+        return other;
+
+    // The largest chord held wins, so that LControl+C is not also C
+    auto best     = std::size_t{other};
+    auto bestSize = std::size_t{0};
+    for (const auto* chords : {&byScancode, &byKey})
+    {
+        for (const auto index : *chords)
+        {
+            const auto& chord = m_chords[index];
+            if ((chord.scancodes & m_heldScancodes) != chord.scancodes || (chord.keys & m_heldKeys) != chord.keys)
+                continue;
+
+            const auto size = chord.size();
+            if (size > bestSize || (size == bestSize && index + 1u < best))
+            {
+                best     = index + 1u;
+                bestSize = size;
+            }
+        }
+    }
+
+    // A key of a chord which is not complete yet, a modifier being pressed for instance
+    if (best == other)
+        return std::nullopt;
+
+    const auto& chord = m_chords[best - 1];
+    auto        first = timestamp;
+    for (auto held : chord.scancodes)
+        first = std::min(first, m_scancodePressedAt[held]);
+    for (auto held : chord.keys)
+        first = std::min(first, m_keyPressedAt[held]);
+
+    if (const auto within = m_chordWithin[best - 1]; within != sf::Time::Zero && timestamp - first > within)
+    {
+        const auto pattern = m_chordPattern[best - 1];
+        m_results.push_back({Result::Kind::ChordTooSlow, pattern, 0, timestamp - first});
+        ++m_statistics[pattern].nearMisses;
+        return other;
+    }
+
+    return best;
+}
+
+void PatternMatcher::advance(std::size_t symbol, sf::Time timestamp)
+{
+    const auto stepTime = [this](std::size_t back)
+    { return m_stepTimes[(m_stepCount - 1 - back) % m_stepTimes.size()]; };
+    const auto report = [this](Result::Kind kind, std::size_t pattern, std::size_t steps, sf::Time duration)
+    {
+        m_results.push_back({kind, pattern, steps, duration});
+        auto& statistics = m_statistics[pattern];
+        if (kind != Result::Kind::Matched)
+            ++statistics.nearMisses;
+        else if (++statistics.matches == 1 || duration < statistics.fastest)
+            statistics.fastest = duration;
+    };
+
+    // A pause longer than any pattern in progress allows starts over
+    if (m_state != root && timestamp - stepTime(0) > m_within[m_state])
+    {
+        const auto depth = std::size_t{m_depth[m_state]};
+        if (depth >= 2 && m_partOf[m_state] != noPattern)
+            report(Result::Kind::TimedOut, m_partOf[m_state], depth, stepTime(0) - stepTime(depth - 1));
+        m_state = root;
+    }
+
+    const auto previous = m_state;
+    m_state             = m_transitions[m_state * m_symbolCount + symbol];
+    m_stepTimes[m_stepCount++ % m_stepTimes.size()] = timestamp;
+
+    // Up Up Up in Up Up Down only shifts the prefix of the pattern, nothing is lost
+    const auto fellBack = m_depth[m_state] < m_depth[previous] ||
+                          (m_depth[m_state] == m_depth[previous] && m_partOf[m_state] != m_partOf[previous]);
+    if (fellBack && m_depth[previous] >= 2 && m_partOf[previous] != noPattern)
+        report(Result::Kind::Broken, m_partOf[previous], m_depth[previous], timestamp - stepTime(m_depth[previous]));
+
+    for (auto i = m_outputBegin[m_state]; i < m_outputBegin[m_state + 1]; ++i)
+    {
+        const auto  p       = m_outputs[i];
+        const auto& pattern = m_patterns[p];
+        const auto  length  = pattern.steps.size();
+
+        auto tooSlow = false;
+        for (std::size_t back = 0; back + 1 < length; ++back)
+            tooSlow |= stepTime(back) - stepTime(back + 1) > pattern.within;
+
+        report(tooSlow ? Result::Kind::TooSlow : Result::Kind::Matched, p, length, timestamp - stepTime(length - 1));
+    }
+}
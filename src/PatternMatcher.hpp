@@ -0,0 +1,124 @@
+#pragma once
+
+#include "ranges.hpp"
+
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Keyboard.hpp>
+
+#include <SFML/System/Time.hpp>
+
+#include <filesystem>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <cstdint>
+
+// Keys which must be held together, by scancode or by key code
+struct Chord
+{
+    EnumBitset<sf::Keyboard::Scancode> scancodes;
+    EnumBitset<sf::Keyboard::Key>      keys;
+
+    std::size_t size() const;
+};
+
+struct Pattern
+{
+    std::string        name;
+    std::vector<Chord> steps;
+    sf::Time           within;      // longest time from one step to the next
+    sf::Time           chordWithin; // longest time between the first and the last press of a chord
+};
+
+// One pattern per line, NAME: STEP... [within MS] [chord MS]. A step is a key, or keys joined with + which must be
+// held together. Keys are scancode names as in sf::Keyboard::Scan, or key codes with a Key:: prefix. Times are in
+// milliseconds, within defaults to 1000 and chords have no limit by default. Returns std::nullopt and the error with
+// its line number if invalid.
+std::optional<std::vector<Pattern>> compilePatterns(std::istream& source, std::string& error);
+
+std::optional<std::vector<Pattern>> loadPatterns(const std::filesystem::path& path, std::string& error);
+
+// Recognizes the patterns in the key presses with an Aho-Corasick automaton over the chords of all patterns, so a
+// press costs a table lookup whatever the number of patterns, plus a subset test per chord containing the key
+class PatternMatcher
+{
+public:
+    struct Result
+    {
+        enum class Kind
+        {
+            Matched,
+            TooSlow,      // every step arrived but one of them later than the pattern allows
+            ChordTooSlow, // the keys of a chord were held together but pressed further apart than allowed
+            Broken,       // another press interrupted the pattern after two steps or more
+            TimedOut,     // the next step didn't come in time after two steps or more
+        };
+
+        Kind        kind;
+        std::size_t pattern;
+        std::size_t steps;    // done, all of them unless broken
+        sf::Time    duration; // from the first step to the last one
+    };
+
+    explicit PatternMatcher(std::vector<Pattern> patterns);
+
+    // Only presses advance the automaton, autorepeat excluded, the results are valid until the next call
+    const std::vector<Result>& handle(const sf::Event& event, sf::Time timestamp);
+
+    const Pattern& getPattern(std::size_t pattern) const;
+    std::size_t    getPatternCount() const;
+
+    // Matches, near misses and the fastest match of every pattern
+    void print(std::ostream& os) const;
+
+private:
+    using State = std::uint32_t;
+
+    static constexpr State       root  = 0;
+    static constexpr std::size_t other = 0; // symbol of the presses which complete no chord
+
+    // Symbol of the press, std::nullopt if it completes no chord yet but belongs to one
+    std::optional<std::size_t> completedChord(sf::Keyboard::Scancode scancode,
+                                              sf::Keyboard::Key      code,
+                                              sf::Time               timestamp);
+    void                       advance(std::size_t symbol, sf::Time timestamp);
+
+    struct Statistics
+    {
+        std::uint32_t matches = 0, nearMisses = 0;
+        sf::Time      fastest = sf::Time::Zero;
+    };
+
+    std::vector<Pattern>     m_patterns;
+    std::vector<Chord>       m_chords;       // distinct chords of all patterns, chord i is symbol i + 1
+    std::vector<sf::Time>    m_chordWithin;  // shortest limit of the patterns using the chord, zero if none
+    std::vector<std::size_t> m_chordPattern; // first pattern using the chord, reported for its near misses
+
+    // Chords containing the key, so that a press only tests those
+    EnumMap<sf::Keyboard::Scancode, std::vector<std::uint16_t>> m_chordsByScancode;
+    EnumMap<sf::Keyboard::Key, std::vector<std::uint16_t>>      m_chordsByKey;
+
+    // Automaton, one row of transitions per state
+    std::size_t                m_symbolCount = 1;
+    std::vector<State>         m_transitions;
+    std::vector<std::uint16_t> m_depth;
+    std::vector<sf::Time>      m_within;      // longest gap still continuing any pattern of the state
+    std::vector<std::size_t>   m_partOf;      // a pattern the state is a proper prefix of, or none
+    std::vector<std::uint32_t> m_outputBegin; // patterns ending in the state, in m_outputs
+    std::vector<std::size_t>   m_outputs;
+
+    // Input state
+    EnumBitset<sf::Keyboard::Scancode>        m_heldScancodes;
+    EnumBitset<sf::Keyboard::Key>             m_heldKeys;
+    EnumMap<sf::Keyboard::Scancode, sf::Time> m_scancodePressedAt;
+    EnumMap<sf::Keyboard::Key, sf::Time>      m_keyPressedAt;
+    State                                     m_state = root;
+    std::vector<sf::Time>                     m_stepTimes; // ring of the times of the last symbols
+    std::uint64_t                             m_stepCount = 0;
+
+    std::vector<Result>     m_results;
+    std::vector<Statistics> m_statistics;
+};
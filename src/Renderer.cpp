@@ -0,0 +1,219 @@
+#include "Renderer.hpp"
+
+#include "Application.hpp"
+#include "TextBuilder.hpp"
+
+#include <SFML/Graphics/View.hpp>
+
+#include <iostream>
+
+namespace
+{
+constexpr auto textSize{14u};
+constexpr auto space{4u};
+constexpr auto lineSize{textSize + space};
+
+// Of the panels on the left of the keyboard, and around the cached area of any text so that outlines aren't clipped
+constexpr auto panelWidth{320.f};
+constexpr auto margin{4.f};
+
+constexpr auto pacingPosition = sf::Vector2f{0, 58 * lineSize};
+constexpr auto pacingLines{6u};
+
+const auto pacingInterval = sf::milliseconds(500);
+
+float getSpacingFactor(const sf::Font& font)
+{
+    return static_cast<float>(lineSize) / font.getLineSpacing(textSize);
+}
+
+// Drawn within lines below position, texts may be clipped beyond
+sf::FloatRect makeArea(const sf::Vector2f& position, unsigned int lines, float width = panelWidth)
+{
+    return {position - sf::Vector2f{margin, margin},
+            {width + 2.f * margin, static_cast<float>(lines * lineSize) + 2.f * margin}};
+}
+
+TablePanel makePanel(Animator& animator, GlyphCache& glyphs, std::u32string_view string, const sf::Vector2f& position)
+{
+    auto panel = TablePanel{animator, glyphs, string, static_cast<float>(lineSize)};
+    panel.setPosition(position);
+
+    return panel;
+}
+
+sf::Text makeText(const sf::Font& font, const sf::String& string, const sf::Vector2f& position)
+{
+    auto text = sf::Text{font, string, textSize};
+    text.setLineSpacing(getSpacingFactor(font));
+    text.setPosition(position);
+
+    return text;
+}
+
+} // namespace
+
+Renderer::Renderer(const sf::Font& font, const Settings& settings, sf::Vector2u size) :
+m_glyphCache{font, textSize, 2.f},
+m_keyPressed{makePanel(m_animator, m_glyphCache, U"Key Pressed", {0, 0}), LayerCache{makeArea({0, 0}, 8)}},
+m_textEntered{makePanel(m_animator, m_glyphCache, U"Text Entered", {0, 8 * lineSize}),
+              LayerCache{makeArea({0, 8 * lineSize}, 4)}},
+m_keyReleased{makePanel(m_animator, m_glyphCache, U"Key Released", {0, 12 * lineSize}),
+              LayerCache{makeArea({0, 12 * lineSize}, 8)}},
+// Many keys held together overlap the mouse panels, so the cache reaches down to the patterns
+m_keyPressedCheck{makeText(font, "", {0, 20 * lineSize}), LayerCache{makeArea({0, 20 * lineSize}, 28)}},
+m_mouseButtonPressed{makePanel(m_animator, m_glyphCache, U"Mouse Button Pressed", {0, 30 * lineSize}),
+                     LayerCache{makeArea({0, 30 * lineSize}, 4)}},
+m_mouseButtonReleased{makePanel(m_animator, m_glyphCache, U"Mouse Button Released", {0, 34 * lineSize}),
+                      LayerCache{makeArea({0, 34 * lineSize}, 4)}},
+m_mouseButtonPressedCheck{makeText(font, "", {0, 38 * lineSize}), LayerCache{makeArea({0, 38 * lineSize}, 10)}},
+m_patterns{makePanel(m_animator, m_glyphCache, U"Patterns", {0, 48 * lineSize}),
+           LayerCache{makeArea({0, 48 * lineSize}, 8)}},
+m_showPatterns{!settings.patterns.empty()},
+m_rollover{makeText(font, "", {320, 8}), LayerCache{makeArea({320, 8}, 3, 1600.f)}},
+m_pacingPanel{makePanel(m_animator, m_glyphCache, U"Frame Pacing", pacingPosition), LayerCache{getPacingArea()}},
+m_keyboardView{m_animator, font, settings.keyboardLayout},
+m_mouseAnalyzerView{font},
+m_eventHistoryView{font},
+m_size{size}
+{
+    m_keyboardView.setPosition({320, 64});
+
+    if (settings.captureBefore != 0 || settings.captureAfter != 0)
+        m_frameRecorder.emplace(size, settings.captureBefore, settings.captureAfter, "captures");
+}
+
+void Renderer::render(sf::RenderWindow& window, const Scene& scene)
+{
+    apply(scene, window);
+
+    // After everything which can start an animation, so that it is drawn from its first step
+    const auto frameTime = m_clock.restart();
+    m_animator.update(frameTime);
+    m_animationCount = m_animator.getAnimationCount();
+
+    window.clear();
+
+    m_keyPressed.draw(window);
+    m_textEntered.draw(window);
+    m_keyReleased.draw(window);
+    m_keyPressedCheck.draw(window);
+
+    m_mouseButtonPressed.draw(window);
+    m_mouseButtonReleased.draw(window);
+    m_mouseButtonPressedCheck.draw(window);
+    if (m_showPatterns)
+        m_patterns.draw(window);
+    m_pacingPanel.draw(window);
+
+    window.draw(m_keyboardView);
+    window.draw(m_mouseAnalyzerView);
+    window.draw(m_eventHistoryView);
+    if (!scene.rollover.empty())
+        m_rollover.draw(window);
+
+    if (m_frameRecorder)
+        m_frameRecorder->capture(window);
+
+    window.display();
+    m_displayTimer.add(m_displayClock.getElapsedTime());
+}
+
+sf::FloatRect Renderer::getPacingArea()
+{
+    return makeArea(pacingPosition, pacingLines);
+}
+
+std::size_t Renderer::getAnimationCount() const
+{
+    return m_animationCount;
+}
+
+void Renderer::print(std::ostream& os) const
+{
+    m_displayTimer.print(os);
+    if (m_frameRecorder)
+        m_frameRecorder->print(os);
+}
+
+void Renderer::apply(const Scene& scene, sf::RenderWindow& window)
+{
+    if (m_size != scene.size)
+    {
+        m_size = scene.size;
+        window.setView(sf::View(sf::FloatRect({}, sf::Vector2f{m_size})));
+    }
+
+    if (m_pacing != scene.pacing)
+    {
+        if (m_pacing)
+            m_displayTimer.print(std::cout);
+
+        m_pacing = scene.pacing;
+        window.setVerticalSyncEnabled(*m_pacing == Pacing::VSync);
+        window.setFramerateLimit(*m_pacing == Pacing::Fixed ? frameRate : 0);
+        m_displayTimer.reset(*m_pacing);
+        m_pacingShownAt = m_displayClock.getElapsedTime() - pacingInterval;
+    }
+
+    if (const auto now = m_displayClock.getElapsedTime(); now - m_pacingShownAt >= pacingInterval)
+    {
+        m_pacingShownAt = now;
+        m_arena.reset();
+
+        auto text = TextBuilder{m_arena};
+        m_displayTimer.describe(text);
+        m_pacingPanel.table.setText(text.view());
+    }
+
+    if (m_captures != scene.captures)
+    {
+        m_captures = scene.captures;
+        if (m_frameRecorder && m_frameRecorder->trigger())
+            std::cout << "Recording the frames around " << scene.captureReason << " to captures\n";
+    }
+
+    m_keyPressed.apply(scene.keyPressed);
+    m_textEntered.apply(scene.textEntered);
+    m_keyReleased.apply(scene.keyReleased);
+    m_keyPressedCheck.apply(scene.keyPressedCheck);
+
+    m_mouseButtonPressed.apply(scene.mouseButtonPressed);
+    m_mouseButtonReleased.apply(scene.mouseButtonReleased);
+    m_mouseButtonPressedCheck.apply(scene.mouseButtonPressedCheck);
+
+    m_patterns.apply(scene.patterns);
+    m_rollover.apply(scene.rollover);
+
+    m_keyboardView.apply(scene.keyboard);
+    m_mouseAnalyzerView.apply(scene.mouse);
+    m_eventHistoryView.apply(scene.history);
+}
+
+void Renderer::Panel::apply(const Scene::Panel& from)
+{
+    // Panels keep their title until something is shown in them
+    if (!from.text.empty())
+        table.setText(from.text);
+
+    if (shines != from.shines)
+    {
+        shines = from.shines;
+        table.shine(from.shineColor);
+    }
+}
+
+void Renderer::Panel::draw(sf::RenderTarget& target)
+{
+    cache.draw(target, sf::RenderStates::Default, table, table.getRevision());
+}
+
+void Renderer::Text::apply(std::u32string_view string)
+{
+    revision += setText(text, string);
+}
+
+void Renderer::Text::draw(sf::RenderTarget& target)
+{
+    cache.draw(target, sf::RenderStates::Default, text, revision);
+}
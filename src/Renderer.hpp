@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Animator.hpp"
+#include "EventHistory.hpp"
+#include "FrameArena.hpp"
+#include "FramePacing.hpp"
+#include "FrameRecorder.hpp"
+#include "GlyphCache.hpp"
+#include "KeyboardView.hpp"
+#include "LayerCache.hpp"
+#include "MouseAnalyzer.hpp"
+#include "Scene.hpp"
+#include "TablePanel.hpp"
+
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Text.hpp>
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <atomic>
+#include <optional>
+#include <ostream>
+#include <string_view>
+
+#include <cstdint>
+
+struct Settings;
+
+// Draws the scenes to the window. It owns every drawable and, once constructed, is the only user of the font, so it
+// may draw from a thread of its own while the events are handled. The panels and texts are drawn through caches, so
+// that a frame costs a quad for each of them which didn't change.
+class Renderer
+{
+public:
+    Renderer(const sf::Font& font, const Settings& settings, sf::Vector2u size);
+
+    // Lays out what changed since the last scene, advances the animations, draws and displays
+    void render(sf::RenderWindow& window, const Scene& scene);
+
+    // May be called from any thread
+    std::size_t getAnimationCount() const;
+
+    // Of the display intervals and the frame recorder
+    void print(std::ostream& os) const;
+
+    // Clicking the pacing panel switches to the next pacing
+    static sf::FloatRect getPacingArea();
+
+private:
+    void apply(const Scene& scene, sf::RenderWindow& window);
+
+    // A panel and the shines of the last scene applied to it
+    struct Panel
+    {
+        void apply(const Scene::Panel& from);
+        void draw(sf::RenderTarget& target);
+
+        TablePanel    table;
+        LayerCache    cache;
+        std::uint32_t shines = 0;
+    };
+
+    struct Text
+    {
+        void apply(std::u32string_view string);
+        void draw(sf::RenderTarget& target);
+
+        sf::Text      text;
+        LayerCache    cache;
+        std::uint32_t revision = 0; // of the string
+    };
+
+    Animator   m_animator;
+    GlyphCache m_glyphCache;
+    sf::Clock  m_clock;
+
+    Panel m_keyPressed, m_textEntered, m_keyReleased;
+    Text  m_keyPressedCheck;
+
+    Panel m_mouseButtonPressed, m_mouseButtonReleased;
+    Text  m_mouseButtonPressedCheck;
+
+    Panel m_patterns;
+    bool  m_showPatterns;
+    Text  m_rollover;
+
+    // The intervals are shown twice a second, described in an arena of the renderer as it may run on another thread
+    Panel                 m_pacingPanel;
+    DisplayTimer          m_displayTimer;
+    sf::Clock             m_displayClock;
+    sf::Time              m_pacingShownAt;
+    std::optional<Pacing> m_pacing; // applied to the window
+    FrameArena            m_arena{1 << 12};
+
+    KeyboardView      m_keyboardView;
+    MouseAnalyzerView m_mouseAnalyzerView;
+    EventHistoryView  m_eventHistoryView;
+
+    std::optional<FrameRecorder> m_frameRecorder;
+
+    // Of the last scene applied
+    sf::Vector2u  m_size;
+    std::uint32_t m_captures = 0;
+
+    std::atomic<std::size_t> m_animationCount{0};
+};
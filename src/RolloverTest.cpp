@@ -0,0 +1,184 @@
+#include "RolloverTest.hpp"
+
+#include "strings.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+namespace
+{
+// Keys which can be held with the fingers resting on the home row, then with the thumbs. No modifier, Alt and Space
+// open the window menu, which takes the focus before the keys are released.
+constexpr auto sequence = std::array{
+    sf::Keyboard::Scan::A,
+    sf::Keyboard::Scan::S,
+    sf::Keyboard::Scan::D,
+    sf::Keyboard::Scan::F,
+    sf::Keyboard::Scan::J,
+    sf::Keyboard::Scan::K,
+    sf::Keyboard::Scan::L,
+    sf::Keyboard::Scan::Semicolon,
+    sf::Keyboard::Scan::V,
+    sf::Keyboard::Scan::Space,
+};
+
+constexpr std::size_t firstStepSize = 2;
+constexpr std::size_t stepCount     = sequence.size() - firstStepSize + 1;
+
+// Marks are refreshed every frame while the test runs
+constexpr auto markDuration = sf::milliseconds(250);
+
+} // namespace
+
+RolloverTest::RolloverTest(const StateSampler& stateSampler, sf::Time now) : m_stateSampler{stateSampler}
+{
+    m_steps.reserve(stepCount);
+    startStep(now);
+}
+
+void RolloverTest::handle(const sf::Event& event, sf::Time timestamp)
+{
+    if (m_finished)
+        return;
+
+    auto& step = m_steps.back();
+    if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>())
+    {
+        if (keyPressed->scancode == sf::Keyboard::Scan::Unknown)
+            return;
+
+        step.held.set(keyPressed->scancode);
+        if (!step.expected[keyPressed->scancode])
+        {
+            addGhost(keyPressed->scancode, timestamp, true);
+            return;
+        }
+
+        if (const auto held = step.held & step.expected; step.maxHeld.count() < held.count())
+            step.maxHeld = held;
+        step.passed = step.maxHeld == step.expected;
+    }
+    else if (const auto* keyReleased = event.getIf<sf::Event::KeyReleased>())
+    {
+        if (keyReleased->scancode == sf::Keyboard::Scan::Unknown)
+            return;
+
+        step.held.reset(keyReleased->scancode);
+
+        // The step is over once everything has been released
+        if (step.held.none() && step.maxHeld.any())
+        {
+            step.end = timestamp;
+            if (m_steps.size() < stepCount)
+                startStep(timestamp);
+            else
+                m_finished = true;
+
+            updateInstructions();
+        }
+    }
+}
+
+bool RolloverTest::update(KeyboardState& keyboard)
+{
+    if (m_finished)
+    {
+        // Show the results of all the steps
+        auto ghosted = Keys{};
+        auto blocked = Keys{};
+        auto passed  = Keys{};
+        for (const auto& step : m_steps)
+        {
+            ghosted |= step.ghosted;
+            blocked |= step.expected & ~step.maxHeld;
+            passed |= step.maxHeld;
+        }
+
+        for (auto scancode : passed & ~blocked & ~ghosted)
+            keyboard.mark(scancode, sf::Color::Green, markDuration);
+        for (auto scancode : blocked & ~ghosted)
+            keyboard.mark(scancode, sf::Color{255, 128, 0}, markDuration);
+        for (auto scancode : ghosted)
+            keyboard.mark(scancode, sf::Color::Red, markDuration);
+
+        const auto justFinished = !m_resultsReported;
+        m_resultsReported       = true;
+        return justFinished;
+    }
+
+    // Keys reported by isKeyPressed without a press event, possibly between two frames
+    auto& step = m_steps.back();
+    for (auto scancode : ~(step.expected | step.ghosted))
+        if (const auto pressed = m_stateSampler.getPressSince(scancode, step.start))
+            addGhost(scancode, *pressed, false);
+
+    for (auto scancode : step.expected)
+        keyboard.mark(scancode, step.held[scancode] ? sf::Color::Green : sf::Color::Blue, markDuration);
+
+    return false;
+}
+
+void RolloverTest::print(std::ostream& os) const
+{
+    auto maxRollover = std::size_t{0};
+
+    os << "\tRollover test\n\n";
+    for (std::size_t i = 0; i < m_steps.size(); ++i)
+    {
+        const auto& step = m_steps[i];
+        maxRollover      = std::max(maxRollover, step.maxHeld.count());
+
+        os << "Step " << i + 1 << ": " << step.expected.count() << " keys " << (step.passed ? "passed" : "failed")
+           << ", held at most " << step.maxHeld.count() << " at once (" << step.start.asMilliseconds() << " ms to "
+           << step.end.asMilliseconds() << " ms)\n";
+
+        for (auto scancode : step.expected & ~step.maxHeld)
+            os << "\tblocked\t" << scancodeIdentifier(scancode) << '\n';
+
+        for (const auto& [scancode, timestamp, fromEvent] : step.ghosts)
+            os << "\tghost\t" << scancodeIdentifier(scancode) << " at " << timestamp.asMilliseconds() << " ms"
+               << (fromEvent ? " (event)" : " (isKeyPressed only)") << '\n';
+    }
+    os << "Maximum rollover: " << maxRollover << " keys\n\n";
+}
+
+const std::u32string& RolloverTest::getInstructions() const
+{
+    return m_instructions;
+}
+
+void RolloverTest::startStep(sf::Time now)
+{
+    auto& step = m_steps.emplace_back();
+    step.start = now;
+    for (std::size_t i = 0; i < firstStepSize + m_steps.size() - 1; ++i)
+        step.expected.set(sequence[i]);
+
+    updateInstructions();
+}
+
+void RolloverTest::addGhost(sf::Keyboard::Scancode scancode, sf::Time timestamp, bool fromEvent)
+{
+    auto& step = m_steps.back();
+    if (step.ghosted[scancode])
+        return;
+
+    step.ghosted.set(scancode);
+    step.ghosts.push_back({scancode, timestamp, fromEvent});
+}
+
+void RolloverTest::updateInstructions()
+{
+    auto instructions = std::string{};
+    if (m_finished)
+        instructions = "Rollover test finished, the results are in rollover.txt\n"
+                       "Green keys were held, orange keys were blocked and red keys ghosted";
+    else
+        instructions = "Rollover test step " + std::to_string(m_steps.size()) + "/" + std::to_string(stepCount) +
+                       ": hold all the blue keys at the same time, then release them all\n"
+                       "Don't press any other key, every other key reported in the meantime is a ghost";
+
+    // The instructions are ASCII
+    m_instructions.assign(instructions.begin(), instructions.end());
+}
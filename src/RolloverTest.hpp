@@ -0,0 +1,62 @@
+#pragma once
+
+#include "KeyboardView.hpp"
+#include "StateSampler.hpp"
+#include "ranges.hpp"
+
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Keyboard.hpp>
+
+#include <SFML/System/Time.hpp>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Guided test asking to hold growing sets of keys to find the maximum rollover and the keys which ghost or block
+class RolloverTest
+{
+public:
+    RolloverTest(const StateSampler& stateSampler, sf::Time now);
+
+    void handle(const sf::Event& event, sf::Time timestamp);
+
+    // Returns true once, when the last step is completed
+    bool update(KeyboardState& keyboard);
+
+    const std::u32string& getInstructions() const;
+
+    void print(std::ostream& os) const;
+
+private:
+    using Keys = EnumBitset<sf::Keyboard::Scancode>;
+
+    struct Ghost
+    {
+        sf::Keyboard::Scancode scancode;
+        sf::Time               timestamp;
+        bool                   fromEvent; // otherwise only seen by the state sampler
+    };
+
+    struct Step
+    {
+        Keys               expected;
+        Keys               held;    // according to the events
+        Keys               maxHeld; // largest set of expected keys held at the same time
+        Keys               ghosted;
+        std::vector<Ghost> ghosts;
+        sf::Time           start;
+        sf::Time           end;
+        bool               passed = false;
+    };
+
+    void startStep(sf::Time now);
+    void addGhost(sf::Keyboard::Scancode scancode, sf::Time timestamp, bool fromEvent);
+    void updateInstructions();
+
+    const StateSampler& m_stateSampler;
+    std::vector<Step>   m_steps;
+    bool                m_finished        = false;
+    bool                m_resultsReported = false;
+    std::u32string      m_instructions;
+};
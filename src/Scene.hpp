@@ -0,0 +1,54 @@
+#pragma once
+
+#include "EventHistory.hpp"
+#include "FramePacing.hpp"
+#include "KeyboardView.hpp"
+#include "MouseAnalyzer.hpp"
+
+#include <SFML/Graphics/Color.hpp>
+
+#include <SFML/System/Vector2.hpp>
+
+#include <string>
+
+#include <cstdint>
+
+// Everything a frame shows, decided while handling events and drawn by the renderer, maybe from another thread. It
+// holds no drawable and no font so that copying it is all the two threads share.
+struct Scene
+{
+    struct Panel
+    {
+        void shine(const sf::Color& color)
+        {
+            shineColor = color;
+            ++shines;
+        }
+
+        std::u32string text;
+        sf::Color      shineColor;
+        std::uint32_t  shines = 0; // the panel glows whenever this changes
+    };
+
+    explicit Scene(const KeyboardLayout& layout) : keyboard{layout}
+    {
+    }
+
+    Panel keyPressed, textEntered, keyReleased;
+    Panel mouseButtonPressed, mouseButtonReleased;
+    Panel patterns; // empty unless patterns are matched
+
+    std::u32string keyPressedCheck, mouseButtonPressedCheck;
+    std::u32string rollover; // instructions, empty unless the rollover test runs
+
+    KeyboardState        keyboard;
+    EventHistory::State  history;
+    MouseAnalyzer::State mouse;
+
+    sf::Vector2u size; // of the view, follows the window
+    Pacing       pacing = Pacing::Deadline;
+
+    // A recording of the frames around this one is started whenever captures changes
+    std::uint32_t captures      = 0;
+    const char*   captureReason = "";
+};
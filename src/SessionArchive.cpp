@@ -0,0 +1,304 @@
+#include "SessionArchive.hpp"
+
+#include <algorithm>
+#include <istream>
+
+namespace
+{
+constexpr char magic[8] = {'S', 'F', 'M', 'L', 'E', 'V', 'T', '1'};
+
+// Records per block, a block is encoded in memory before it is written
+constexpr std::size_t blockSize = 4096;
+
+// Longest encoding of a column, only used to detect corrupt files
+constexpr std::uint64_t maxColumnSize = blockSize * 2 * 10;
+
+enum class Encoding
+{
+    Delta, // difference to the previous record, for values which change little from one event to the next
+    Runs,  // value and repetitions, for columns with few distinct values
+    Plain,
+};
+
+struct Codec
+{
+    SessionArchive::Column column;
+    Encoding               encoding;
+    std::int64_t (*get)(const EventRecord&);
+    bool (*set)(EventRecord&, std::int64_t); // returns false if the value is out of range
+};
+
+template <typename Field>
+bool assign(Field& field, std::int64_t value)
+{
+    field = static_cast<Field>(value);
+    return static_cast<std::int64_t>(field) == value;
+}
+
+// Same order as the columns are stored in
+constexpr Codec codecs[] = {
+    {SessionArchive::Timestamp,
+     Encoding::Delta,
+     [](const EventRecord& record) -> std::int64_t { return record.timestamp; },
+     [](EventRecord& record, std::int64_t value) { return assign(record.timestamp, value); }},
+    {SessionArchive::Type,
+     Encoding::Runs,
+     [](const EventRecord& record) -> std::int64_t { return static_cast<std::int64_t>(record.type); },
+     [](EventRecord& record, std::int64_t value)
+     { return 0 <= value && value < std::int64_t{EventRecord::typeCount} && assign(record.type, value); }},
+    {SessionArchive::Flags,
+     Encoding::Runs,
+     [](const EventRecord& record) -> std::int64_t { return record.flags; },
+     [](EventRecord& record, std::int64_t value) { return assign(record.flags, value); }},
+    {SessionArchive::Code,
+     Encoding::Delta,
+     [](const EventRecord& record) -> std::int64_t { return record.code; },
+     [](EventRecord& record, std::int64_t value) { return assign(record.code, value); }},
+    {SessionArchive::Scancode,
+     Encoding::Delta,
+     [](const EventRecord& record) -> std::int64_t { return record.scancode; },
+     [](EventRecord& record, std::int64_t value) { return assign(record.scancode, value); }},
+    {SessionArchive::Localized,
+     Encoding::Delta,
+     [](const EventRecord& record) -> std::int64_t { return record.localized; },
+     [](EventRecord& record, std::int64_t value) { return assign(record.localized, value); }},
+    {SessionArchive::Delocalized,
+     Encoding::Delta,
+     [](const EventRecord& record) -> std::int64_t { return record.delocalized; },
+     [](EventRecord& record, std::int64_t value) { return assign(record.delocalized, value); }},
+    {SessionArchive::Unicode,
+     Encoding::Delta,
+     [](const EventRecord& record) -> std::int64_t { return record.unicode; },
+     [](EventRecord& record, std::int64_t value) { return assign(record.unicode, value); }},
+    {SessionArchive::Latency,
+     Encoding::Plain,
+     [](const EventRecord& record) -> std::int64_t { return record.latency; },
+     [](EventRecord& record, std::int64_t value) { return assign(record.latency, value); }},
+};
+
+void putVarint(std::string& output, std::uint64_t value)
+{
+    for (; value >= 0x80; value >>= 7)
+        output += static_cast<char>(value | 0x80);
+    output += static_cast<char>(value);
+}
+
+// Small negative numbers get small codes too
+std::uint64_t zigzag(std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+template <typename Source>
+bool getVarint(Source& source, std::uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = 0;
+        if (!source.get(byte))
+            return false;
+
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+struct StreamSource
+{
+    bool get(int& byte)
+    {
+        byte = stream.get();
+        return byte != std::istream::traits_type::eof();
+    }
+
+    std::istream& stream;
+};
+
+struct BufferSource
+{
+    bool get(int& byte)
+    {
+        if (it == end)
+            return false;
+
+        byte = static_cast<unsigned char>(*it++);
+        return true;
+    }
+
+    std::string::const_iterator it, end;
+};
+
+void encode(const Codec& codec, const std::vector<EventRecord>& records, std::string& output)
+{
+    auto previous = std::int64_t{0};
+    for (auto it = records.begin(); it != records.end();)
+    {
+        const auto value = codec.get(*it);
+        switch (codec.encoding)
+        {
+            case Encoding::Delta:
+                putVarint(output, zigzag(value - previous));
+                previous = value;
+                ++it;
+                break;
+            case Encoding::Runs:
+            {
+                const auto end = std::find_if(it, records.end(), [&](const auto& r) { return codec.get(r) != value; });
+                putVarint(output, zigzag(value));
+                putVarint(output, static_cast<std::uint64_t>(end - it));
+                it = end;
+                break;
+            }
+            case Encoding::Plain:
+                putVarint(output, zigzag(value));
+                ++it;
+                break;
+        }
+    }
+}
+
+bool decode(const Codec& codec, const std::string& input, std::vector<EventRecord>& records)
+{
+    auto source   = BufferSource{input.begin(), input.end()};
+    auto previous = std::int64_t{0};
+    for (std::size_t i = 0; i < records.size();)
+    {
+        auto code = std::uint64_t{};
+        if (!getVarint(source, code))
+            return false;
+
+        auto value = unzigzag(code);
+        auto count = std::uint64_t{1};
+        if (codec.encoding == Encoding::Delta)
+            value = previous += value;
+        else if (codec.encoding == Encoding::Runs && (!getVarint(source, count) || count > records.size() - i))
+            return false;
+
+        for (; count > 0; --count)
+            if (!codec.set(records[i++], value))
+                return false;
+    }
+
+    return source.it == source.end;
+}
+
+} // namespace
+
+namespace SessionArchive
+{
+Writer::Writer(const std::filesystem::path& path) : m_file{path, std::ios::binary}
+{
+    m_file.write(magic, sizeof(magic));
+    m_block.reserve(blockSize);
+}
+
+Writer::~Writer()
+{
+    writeBlock();
+}
+
+bool Writer::isOpen() const
+{
+    return m_file.is_open();
+}
+
+void Writer::write(const EventRecord& record)
+{
+    m_block.push_back(record);
+    if (m_block.size() == blockSize)
+        writeBlock();
+}
+
+void Writer::writeBlock()
+{
+    if (m_block.empty() || !m_file.is_open())
+        return;
+
+    m_buffer.clear();
+    putVarint(m_buffer, m_block.size());
+    for (const auto& codec : codecs)
+    {
+        m_column.clear();
+        encode(codec, m_block, m_column);
+        putVarint(m_buffer, m_column.size());
+        m_buffer += m_column;
+    }
+
+    // A crash loses at most the block being filled
+    m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_file.flush();
+    m_block.clear();
+}
+
+Reader::Reader(const std::filesystem::path& path) : m_file{path, std::ios::binary}
+{
+    char header[sizeof(magic)] = {};
+    m_corrupt = m_file.is_open() && (!m_file.read(header, sizeof(header)) || !std::equal(header, header + 8, magic));
+}
+
+bool Reader::isOpen() const
+{
+    return m_file.is_open();
+}
+
+bool Reader::read(std::vector<EventRecord>& records, std::uint16_t columns)
+{
+    if (!m_file.is_open() || m_corrupt || m_file.peek() == std::ifstream::traits_type::eof())
+        return false;
+
+    auto source = StreamSource{m_file};
+    auto count  = std::uint64_t{};
+    if (!getVarint(source, count) || count == 0 || count > blockSize)
+    {
+        m_corrupt = true;
+        return false;
+    }
+
+    records.assign(count, EventRecord{});
+    for (const auto& codec : codecs)
+    {
+        auto size = std::uint64_t{};
+        if (!getVarint(source, size) || size > maxColumnSize)
+        {
+            m_corrupt = true;
+            return false;
+        }
+
+        // Seeking past the end would succeed, a truncated column is only found by reading through it
+        if ((columns & codec.column) == 0)
+        {
+            if (m_file.ignore(static_cast<std::streamsize>(size)).gcount() != static_cast<std::streamsize>(size))
+            {
+                m_corrupt = true;
+                return false;
+            }
+            continue;
+        }
+
+        m_column.resize(size);
+        if (!m_file.read(m_column.data(), static_cast<std::streamsize>(size)) || !decode(codec, m_column, records))
+        {
+            m_corrupt = true;
+            return false;
+        }
+    }
+
+    m_corrupt = !m_file;
+    return !m_corrupt;
+}
+
+bool Reader::isCorrupt() const
+{
+    return m_corrupt;
+}
+
+} // namespace SessionArchive
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "EventRecord.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <cstdint>
+
+// Columnar storage of the event records of a session. Records are written in blocks, each column of a block is
+// delta or run length encoded as variable length integers, so readers can skip the columns they don't need.
+namespace SessionArchive
+{
+enum Column : std::uint16_t
+{
+    Timestamp   = 1 << 0,
+    Type        = 1 << 1,
+    Flags       = 1 << 2,
+    Code        = 1 << 3,
+    Scancode    = 1 << 4,
+    Localized   = 1 << 5,
+    Delocalized = 1 << 6,
+    Unicode     = 1 << 7,
+    Latency     = 1 << 8,
+    AllColumns  = (1 << 9) - 1,
+};
+
+constexpr auto extension = ".events";
+
+class Writer
+{
+public:
+    // Replaces any file at path
+    explicit Writer(const std::filesystem::path& path);
+
+    // Writes the last block
+    ~Writer();
+
+    Writer(const Writer&)            = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    bool isOpen() const;
+
+    void write(const EventRecord& record);
+
+private:
+    void writeBlock();
+
+    std::ofstream            m_file;
+    std::vector<EventRecord> m_block;
+    std::string              m_buffer; // encoded block
+    std::string              m_column;
+};
+
+class Reader
+{
+public:
+    explicit Reader(const std::filesystem::path& path);
+
+    bool isOpen() const;
+
+    // Replaces records with the next block, the columns which are not requested keep their default values.
+    // Returns false at the end of the file or if it is corrupt.
+    bool read(std::vector<EventRecord>& records, std::uint16_t columns);
+
+    bool isCorrupt() const;
+
+private:
+    std::ifstream m_file;
+    std::string   m_column;
+    bool          m_corrupt = false;
+};
+
+} // namespace SessionArchive
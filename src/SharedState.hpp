@@ -0,0 +1,139 @@
+#pragma once
+
+#include "EventRecord.hpp"
+
+#include <SFML/Window/Keyboard.hpp>
+#include <SFML/Window/Mouse.hpp>
+
+#include <array>
+#include <atomic>
+#include <optional>
+#include <type_traits>
+
+#include <cstdint>
+#include <cstring>
+
+// Layout of the shared memory segment published with --shm and read by SFML-Input-Reader.
+// There is a single writer which never waits, readers retry when a seqlock shows they raced with it. A writer which
+// died halfway leaves a sequence odd for good, so readers give up after a while and report a torn read.
+struct SharedState
+{
+    using Word = std::uint64_t;
+
+    static_assert(std::atomic<Word>::is_always_lock_free, "Shared memory needs lock free atomics");
+    static_assert(std::is_trivially_copyable_v<EventRecord>);
+
+    static constexpr std::uint32_t magicNumber   = 0x53464d49; // "SFMI"
+    static constexpr std::uint32_t layoutVersion = 1;
+    static constexpr std::size_t   eventCapacity = 256;
+    static constexpr int           maxRetries    = 1 << 16;
+
+    // Keys are bits 0 to ScancodeCount - 1, buttons follow
+    static constexpr std::size_t stateBits  = sf::Keyboard::ScancodeCount + sf::Mouse::ButtonCount;
+    static constexpr std::size_t stateWords = (stateBits + 63) / 64;
+    static constexpr std::size_t eventWords = (sizeof(EventRecord) + sizeof(Word) - 1) / sizeof(Word);
+
+    using State = std::array<Word, stateWords>;
+
+    struct Slot
+    {
+        std::atomic<Word>                         sequence{0}; // 2 * (index + 1) once event number index is written
+        std::array<std::atomic<Word>, eventWords> words{};
+    };
+
+    std::uint32_t magic   = magicNumber;
+    std::uint32_t version = layoutVersion;
+
+    std::atomic<Word>                         stateSequence{0}; // odd while the state is being written
+    std::array<std::atomic<Word>, stateWords> state{};
+
+    std::atomic<Word>               eventCount{0}; // events published since the start
+    std::array<Slot, eventCapacity> events;
+
+    // Writer side
+
+    void writeState(const State& newState)
+    {
+        const auto sequence = stateSequence.load(std::memory_order_relaxed);
+        stateSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < stateWords; ++i)
+            state[i].store(newState[i], std::memory_order_relaxed);
+        stateSequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    void writeEvent(const EventRecord& record)
+    {
+        auto words = std::array<Word, eventWords>{};
+        std::memcpy(words.data(), &record, sizeof(record));
+
+        const auto index = eventCount.load(std::memory_order_relaxed);
+        auto&      slot  = events[index % eventCapacity];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < eventWords; ++i)
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        slot.sequence.store(2 * (index + 1), std::memory_order_release);
+        eventCount.store(index + 1, std::memory_order_release);
+    }
+
+    // Reader side
+
+    enum class Read
+    {
+        Done,
+        Missing, // not written yet or already overwritten
+        Torn,
+    };
+
+    // Returns nothing if the read stays torn
+    std::optional<State> readState() const
+    {
+        auto copy = State{};
+        for (int retry = 0; retry < maxRetries; ++retry)
+        {
+            const auto before = stateSequence.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < stateWords; ++i)
+                copy[i] = state[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (before % 2 == 0 && before == stateSequence.load(std::memory_order_relaxed))
+                return copy;
+        }
+
+        return std::nullopt;
+    }
+
+    Read readEvent(Word index, EventRecord& record) const
+    {
+        const auto& slot  = events[index % eventCapacity];
+        auto        words = std::array<Word, eventWords>{};
+        for (int retry = 0; retry < maxRetries; ++retry)
+        {
+            const auto before = slot.sequence.load(std::memory_order_acquire);
+            if (before != 2 * (index + 1))
+            {
+                if (before % 2 == 0)
+                    return Read::Missing;
+                continue;
+            }
+
+            for (std::size_t i = 0; i < eventWords; ++i)
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (before == slot.sequence.load(std::memory_order_relaxed))
+            {
+                std::memcpy(static_cast<void*>(&record), words.data(), sizeof(record));
+                return Read::Done;
+            }
+        }
+
+        return Read::Torn;
+    }
+
+    static bool isSet(const State& state, std::size_t bit)
+    {
+        return (state[bit / 64] >> (bit % 64)) & 1;
+    }
+};
@@ -0,0 +1,114 @@
+#include "SharedStatePublisher.hpp"
+
+#include <iostream>
+#include <new>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#define SHARED_STATE_POSIX
+#endif
+
+SharedStatePublisher::SharedStatePublisher(std::string name) : m_name{std::move(name)}
+{
+    if (m_name.empty() || m_name.front() != '/')
+        m_name.insert(m_name.begin(), '/');
+
+#ifdef SHARED_STATE_POSIX
+    // Another instance publishing under the same name would be wiped, and its segment removed when either exits
+    const auto descriptor = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (descriptor == -1 && errno == EEXIST)
+    {
+        std::cout << "Error: shared memory " << m_name << " is in use, by another instance or left over by a crash\n";
+        return;
+    }
+    if (descriptor == -1)
+    {
+        std::cout << "Error: cannot open shared memory " << m_name << '\n';
+        return;
+    }
+
+    void* address = MAP_FAILED;
+    if (ftruncate(descriptor, sizeof(SharedState)) == 0)
+        address = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+
+    if (address == MAP_FAILED)
+    {
+        std::cout << "Error: cannot map shared memory " << m_name << '\n';
+        shm_unlink(m_name.c_str());
+        return;
+    }
+
+    m_shared = new (address) SharedState{};
+#else
+    std::cout << "Error: shared memory is only supported on POSIX systems\n";
+#endif
+}
+
+SharedStatePublisher::~SharedStatePublisher()
+{
+#ifdef SHARED_STATE_POSIX
+    if (m_shared)
+    {
+        m_shared->~SharedState();
+        munmap(m_shared, sizeof(SharedState));
+        shm_unlink(m_name.c_str());
+    }
+#endif
+}
+
+bool SharedStatePublisher::isOpen() const
+{
+    return m_shared != nullptr;
+}
+
+void SharedStatePublisher::publish(const EventRecord& record)
+{
+    if (!m_shared)
+        return;
+
+    auto bit = std::size_t{SharedState::stateBits};
+    switch (record.type)
+    {
+        case EventRecord::Type::KeyPressed:
+        case EventRecord::Type::KeyReleased:
+            if (record.scancode >= 0)
+                bit = static_cast<std::size_t>(record.scancode);
+            break;
+        case EventRecord::Type::MouseButtonPressed:
+        case EventRecord::Type::MouseButtonReleased:
+            bit = sf::Keyboard::ScancodeCount + static_cast<std::size_t>(record.code);
+            break;
+        case EventRecord::Type::MissingRelease:
+        case EventRecord::Type::LostRelease:
+            // Released without an event, the bit would stay set otherwise
+            bit = record.scancode >= 0 ? static_cast<std::size_t>(record.scancode)
+                                       : sf::Keyboard::ScancodeCount + static_cast<std::size_t>(record.code);
+            break;
+        default:
+            break;
+    }
+
+    if (bit < SharedState::stateBits)
+    {
+        const auto pressed = record.type == EventRecord::Type::KeyPressed ||
+                             record.type == EventRecord::Type::MouseButtonPressed;
+        const auto mask    = SharedState::Word{1} << (bit % 64);
+        auto&      word    = m_state[bit / 64];
+        const auto updated = pressed ? word | mask : word & ~mask;
+
+        // Key repeats don't change the state
+        if (updated != word)
+        {
+            word = updated;
+            m_shared->writeState(m_state);
+        }
+    }
+
+    m_shared->writeEvent(record);
+}
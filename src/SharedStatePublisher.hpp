@@ -0,0 +1,28 @@
+#pragma once
+
+#include "EventRecord.hpp"
+#include "SharedState.hpp"
+
+#include <string>
+
+// Publishes the key and button state and the recent events in POSIX shared memory for other processes
+class SharedStatePublisher
+{
+public:
+    // The segment is named /name, it is created unless it exists and removed again on destruction
+    explicit SharedStatePublisher(std::string name);
+    ~SharedStatePublisher();
+
+    SharedStatePublisher(const SharedStatePublisher&)            = delete;
+    SharedStatePublisher& operator=(const SharedStatePublisher&) = delete;
+
+    bool isOpen() const;
+
+    // Never waits for readers
+    void publish(const EventRecord& record);
+
+private:
+    std::string        m_name;
+    SharedState*       m_shared = nullptr;
+    SharedState::State m_state{};
+};
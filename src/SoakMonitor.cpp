@@ -0,0 +1,180 @@
+#include "SoakMonitor.hpp"
+
+#include "allocations.hpp"
+
+#include <SFML/Window/Keyboard.hpp>
+#include <SFML/Window/Mouse.hpp>
+
+#include <algorithm>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define SOAK_MONITOR_POSIX
+#endif
+
+namespace
+{
+constexpr auto letterCount = 26;
+
+std::int64_t readResidentBytes()
+{
+#ifdef __linux__
+    // Total program size and resident set size, in pages
+    auto statm = std::ifstream{"/proc/self/statm"};
+    auto size = std::int64_t{0}, resident = std::int64_t{0};
+    if (statm >> size >> resident)
+        return resident * sysconf(_SC_PAGESIZE);
+#endif
+    return -1;
+}
+
+std::int64_t countOpenHandles()
+{
+#ifdef SOAK_MONITOR_POSIX
+    // Includes the descriptor used to list them
+    auto error   = std::error_code{};
+    auto count   = std::int64_t{0};
+    auto entries = std::filesystem::directory_iterator{"/dev/fd", error};
+    for (; !error && entries != std::filesystem::directory_iterator{}; entries.increment(error))
+        ++count;
+    if (!error)
+        return count;
+#endif
+    return -1;
+}
+
+sf::Time percentile(const std::vector<std::int64_t>& sorted, std::size_t percent)
+{
+    return sorted.empty() ? sf::Time::Zero : sf::microseconds(sorted[(sorted.size() - 1) * percent / 100]);
+}
+
+void printGrowth(std::ostream& os, std::int64_t value, std::int64_t first, std::int64_t unit, const char* suffix)
+{
+    if (value < 0)
+    {
+        os << "unknown\n";
+        return;
+    }
+
+    os << value / unit << suffix << ", ";
+    if (value >= first)
+        os << '+';
+    os << (value - first) / unit << suffix << " since the start\n";
+}
+
+} // namespace
+
+SoakMonitor::SoakMonitor(const std::filesystem::path& path, sf::Time now) :
+m_file{path, std::ios::app},
+m_lastOperatorInput{now},
+m_nextSample{now}
+{
+    m_frameTimes.reserve(4096);
+
+    m_file << "# seconds\tevents\tsynthetic\tframe_median_us\tframe_p99_us\tframe_max_us\tresident_bytes"
+              "\tlive_allocations\topen_handles\tanimations\tplaying_voices\n";
+}
+
+bool SoakMonitor::isOpen() const
+{
+    return m_file.is_open();
+}
+
+std::optional<sf::Event> SoakMonitor::synthesize(sf::Time now)
+{
+    if (now - m_lastOperatorInput < m_idleTimeout || now < m_nextSynthetic)
+        return std::nullopt;
+
+    m_nextSynthetic = now + m_syntheticInterval;
+    ++m_syntheticEvents;
+
+    // Each letter is pressed, typed and released, followed by a click
+    const auto step     = m_syntheticStep++;
+    const auto letter   = static_cast<int>(step / 5 % letterCount);
+    const auto code     = static_cast<sf::Keyboard::Key>(static_cast<int>(sf::Keyboard::Key::A) + letter);
+    const auto scancode = static_cast<sf::Keyboard::Scancode>(static_cast<int>(sf::Keyboard::Scan::A) + letter);
+    switch (step % 5)
+    {
+        case 0:
+            return sf::Event{sf::Event::KeyPressed{code, scancode}};
+        case 1:
+            return sf::Event{sf::Event::TextEntered{static_cast<char32_t>(U'a' + letter)}};
+        case 2:
+            return sf::Event{sf::Event::KeyReleased{code, scancode}};
+        case 3:
+            return sf::Event{sf::Event::MouseButtonPressed{sf::Mouse::Button::Left, {}}};
+        default:
+            return sf::Event{sf::Event::MouseButtonReleased{sf::Mouse::Button::Left, {}}};
+    }
+}
+
+void SoakMonitor::addFrame(sf::Time now, sf::Time frameTime, std::size_t events)
+{
+    if (events != 0)
+        m_lastOperatorInput = now;
+
+    m_events += events;
+    m_frameTimes.push_back(frameTime.asMicroseconds());
+}
+
+bool SoakMonitor::update(sf::Time now, std::size_t animations, std::size_t playingVoices)
+{
+    if (now < m_nextSample)
+        return false;
+
+    m_nextSample = now + m_sampleInterval;
+
+    std::sort(m_frameTimes.begin(), m_frameTimes.end());
+
+    auto sample            = Sample{};
+    sample.time            = now;
+    sample.events          = m_events + m_syntheticEvents;
+    sample.syntheticEvents = m_syntheticEvents;
+    sample.frameMedian     = percentile(m_frameTimes, 50);
+    sample.frameP99        = percentile(m_frameTimes, 99);
+    sample.frameMax        = percentile(m_frameTimes, 100);
+    sample.residentBytes   = readResidentBytes();
+    sample.liveAllocations = getLiveAllocationCount();
+    sample.openHandles     = countOpenHandles();
+    sample.animations      = animations;
+    sample.playingVoices   = playingVoices;
+
+    m_events = m_syntheticEvents = 0;
+    m_frameTimes.clear();
+
+    m_file << sample.time.asSeconds() << '\t' << sample.events << '\t' << sample.syntheticEvents << '\t'
+           << sample.frameMedian.asMicroseconds() << '\t' << sample.frameP99.asMicroseconds() << '\t'
+           << sample.frameMax.asMicroseconds() << '\t' << sample.residentBytes << '\t' << sample.liveAllocations << '\t'
+           << sample.openHandles << '\t' << sample.animations << '\t' << sample.playingVoices << '\n';
+    m_file.flush();
+
+    if (!m_first)
+        m_first = sample;
+    m_last = sample;
+
+    return true;
+}
+
+void SoakMonitor::print(std::ostream& os) const
+{
+    if (!m_last)
+        return;
+
+    const auto& first = *m_first;
+    const auto& last  = *m_last;
+    const auto  span  = std::max(m_sampleInterval.asSeconds(), 1.f);
+
+    os << "\tSoak after " << static_cast<int>((last.time - first.time).asSeconds()) << " s\n\n";
+    os << "Events: " << static_cast<float>(last.events) / span << "/s, "
+       << static_cast<float>(last.syntheticEvents) / span << "/s of them synthetic\n";
+    os << "Frame time: " << last.frameMedian.asMicroseconds() << " us median, " << last.frameP99.asMicroseconds()
+       << " us 99th percentile, " << last.frameMax.asMicroseconds() << " us at most\n";
+    os << "Resident memory: ";
+    printGrowth(os, last.residentBytes, first.residentBytes, 1024, " kB");
+    os << "Live allocations: ";
+    printGrowth(os, last.liveAllocations, first.liveAllocations, 1, "");
+    os << "Open handles: ";
+    printGrowth(os, last.openHandles, first.openHandles, 1, "");
+    os << "Animations: " << last.animations << ", playing voices: " << last.playingVoices << "\n\n";
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <SFML/Window/Event.hpp>
+
+#include <SFML/System/Time.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include <cstdint>
+
+// Samples throughput, frame times and resource usage while the tool runs for days, and types by itself while nobody
+// is at the station so that the event path keeps being exercised
+class SoakMonitor
+{
+public:
+    struct Sample
+    {
+        sf::Time      time;
+        std::uint64_t events = 0, syntheticEvents = 0; // since the previous sample
+        sf::Time      frameMedian, frameP99, frameMax; // time spent updating and rendering
+        std::int64_t  residentBytes   = -1;            // -1 if the platform doesn't tell
+        std::int64_t  liveAllocations = 0;
+        std::int64_t  openHandles     = -1; // -1 if the platform doesn't tell
+        std::size_t   animations = 0, playingVoices = 0;
+    };
+
+    // Samples are appended to the file as tab separated lines, each run starts with a header comment
+    SoakMonitor(const std::filesystem::path& path, sf::Time now);
+
+    bool isOpen() const;
+
+    // Next synthetic event, if nobody provided input for a while and one is due
+    std::optional<sf::Event> synthesize(sf::Time now);
+
+    // events are the ones from the window, any of them means that an operator is present
+    void addFrame(sf::Time now, sf::Time frameTime, std::size_t events);
+
+    // Returns true if a sample was taken, the gauges are the ones the monitor cannot read by itself
+    bool update(sf::Time now, std::size_t animations, std::size_t playingVoices);
+
+    // Last sample and the growth since the first one
+    void print(std::ostream& os) const;
+
+private:
+    static inline const sf::Time m_sampleInterval    = sf::seconds(60);
+    static inline const sf::Time m_idleTimeout       = sf::seconds(30);
+    static inline const sf::Time m_syntheticInterval = sf::milliseconds(50);
+
+    std::ofstream m_file;
+
+    sf::Time      m_lastOperatorInput;
+    sf::Time      m_nextSynthetic;
+    std::uint64_t m_syntheticStep = 0;
+
+    sf::Time                  m_nextSample;
+    std::uint64_t             m_events = 0, m_syntheticEvents = 0;
+    std::vector<std::int64_t> m_frameTimes; // microseconds, since the previous sample
+
+    std::optional<Sample> m_first, m_last;
+};
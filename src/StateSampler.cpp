@@ -0,0 +1,159 @@
+#include "StateSampler.hpp"
+
+namespace
+{
+// How long events and samples may be apart and still be considered the same input change
+constexpr auto eventTolerance = sf::milliseconds(50);
+
+StateSampler::Input toInput(std::size_t input)
+{
+    if (input < sf::Keyboard::ScancodeCount)
+        return static_cast<sf::Keyboard::Scancode>(input);
+
+    return static_cast<sf::Mouse::Button>(input - sf::Keyboard::ScancodeCount);
+}
+
+bool isBetween(sf::Time time, sf::Time from, sf::Time to)
+{
+    return from <= time && time <= to;
+}
+
+} // namespace
+
+StateSampler::StateSampler(unsigned int rate) :
+m_period{sf::seconds(1.f / static_cast<float>(rate))},
+m_tolerance{eventTolerance + m_period * std::int64_t{2}}
+{
+}
+
+void StateSampler::sample(sf::Time now)
+{
+    if (now < m_next)
+        return;
+
+    // Skip the missed periods instead of sampling in a burst when falling behind
+    m_next += m_period;
+    if (m_next <= now)
+        m_next = now + m_period;
+
+    const auto& state = m_snapshot.read();
+    for (std::size_t input = 0; input < inputCount; ++input)
+    {
+        auto& sampled = m_sampled[input];
+        if (state[input] == sampled.pressed)
+            continue;
+
+        sampled.pressed = state[input];
+        if (sampled.pressed)
+            sampled.lastPress = now;
+        else
+            sampled.lastRelease = now;
+    }
+}
+
+void StateSampler::handle(const sf::Event& event, sf::Time timestamp)
+{
+    auto report = [&](std::size_t input, bool pressed)
+    {
+        auto& reported     = m_reported[input];
+        reported.pressed   = pressed;
+        reported.changedAt = timestamp;
+        reported.unchecked = true;
+    };
+
+    if (event.is<sf::Event::FocusLost>())
+    {
+        // Inputs keep being sampled while another window receives their events
+        m_focused = false;
+    }
+    else if (event.is<sf::Event::FocusGained>())
+    {
+        m_focused = true;
+        for (std::size_t input = 0; input < inputCount; ++input)
+        {
+            const auto& sampled    = m_sampled[input];
+            auto&       reported   = m_reported[input];
+            reported.pressed       = sampled.pressed;
+            reported.changedAt     = timestamp;
+            reported.unchecked     = false;
+            reported.flaggedSample = reported.pressed ? sampled.lastPress : sampled.lastRelease;
+        }
+    }
+    else if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>())
+    {
+        if (keyPressed->scancode != sf::Keyboard::Scan::Unknown)
+            report(static_cast<std::size_t>(keyPressed->scancode), true);
+    }
+    else if (const auto* keyReleased = event.getIf<sf::Event::KeyReleased>())
+    {
+        if (keyReleased->scancode != sf::Keyboard::Scan::Unknown)
+            report(static_cast<std::size_t>(keyReleased->scancode), false);
+    }
+    else if (const auto* buttonPressed = event.getIf<sf::Event::MouseButtonPressed>())
+    {
+        report(sf::Keyboard::ScancodeCount + static_cast<std::size_t>(buttonPressed->button), true);
+    }
+    else if (const auto* buttonReleased = event.getIf<sf::Event::MouseButtonReleased>())
+    {
+        report(sf::Keyboard::ScancodeCount + static_cast<std::size_t>(buttonReleased->button), false);
+    }
+}
+
+const std::vector<StateSampler::Finding>& StateSampler::check(sf::Time now)
+{
+    m_findings.clear();
+    if (!m_focused)
+        return m_findings;
+
+    const auto& sampledInputs = m_snapshot.sampled();
+    for (std::size_t input = 0; input < inputCount; ++input)
+    {
+        // Events of inputs the snapshot can't see pressed would all look like phantoms
+        if (!sampledInputs[input])
+            continue;
+
+        const auto& sampled  = m_sampled[input];
+        auto&       reported = m_reported[input];
+
+        const auto pressed       = sampled.pressed;
+        const auto lastPress     = sampled.lastPress;
+        const auto lastRelease   = sampled.lastRelease;
+        const auto sampledChange = pressed ? lastPress : lastRelease;
+
+        // The event matching the last sampled change is overdue
+        if (pressed != reported.pressed && reported.changedAt < sampledChange && sampledChange + m_tolerance < now &&
+            reported.flaggedSample != sampledChange)
+        {
+            reported.flaggedSample = sampledChange;
+            m_findings.push_back({pressed ? Finding::Kind::MissedPress : Finding::Kind::MissingRelease,
+                                  toInput(input),
+                                  sampledChange});
+        }
+
+        // The last event should have shown up in the samples by now
+        if (reported.unchecked && reported.changedAt + m_tolerance < now)
+        {
+            reported.unchecked = false;
+
+            const auto from = reported.changedAt - m_tolerance;
+            const auto to   = reported.changedAt + m_tolerance;
+            const auto seen = isBetween(lastPress, from, to) || isBetween(lastRelease, from, to) ||
+                              (pressed == reported.pressed && sampledChange <= to);
+            if (!seen)
+                m_findings.push_back({reported.pressed ? Finding::Kind::PhantomPress : Finding::Kind::PhantomRelease,
+                                      toInput(input),
+                                      reported.changedAt});
+        }
+    }
+
+    return m_findings;
+}
+
+std::optional<sf::Time> StateSampler::getPressSince(sf::Keyboard::Scancode scancode, sf::Time since) const
+{
+    const auto lastPress = m_sampled[static_cast<std::size_t>(scancode)].lastPress;
+    if (lastPress < since)
+        return std::nullopt;
+
+    return lastPress;
+}
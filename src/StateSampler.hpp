@@ -0,0 +1,76 @@
+#pragma once
+
+#include "InputSnapshot.hpp"
+
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Keyboard.hpp>
+#include <SFML/Window/Mouse.hpp>
+
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <optional>
+#include <variant>
+#include <vector>
+
+// Samples the keyboard and mouse button state between event polls and cross-checks it with the window events. The
+// state is read on the event thread, as SFML doesn't allow reading it from another thread on every platform.
+class StateSampler
+{
+public:
+    using Input = std::variant<sf::Keyboard::Scancode, sf::Mouse::Button>;
+
+    struct Finding
+    {
+        enum class Kind
+        {
+            MissedPress,    // sampled pressed but no press event arrived
+            MissingRelease, // sampled released but no release event arrived, the key is stuck
+            PhantomPress,   // a press event arrived but the input was never sampled pressed
+            PhantomRelease, // a release event arrived but the input was never sampled released
+        };
+
+        Kind     kind;
+        Input    input;
+        sf::Time timestamp;
+    };
+
+    explicit StateSampler(unsigned int rate);
+
+    // Reads the state if a sampling period has passed since the last time, to be called as often as events are polled
+    void sample(sf::Time now);
+
+    void handle(const sf::Event& event, sf::Time timestamp);
+    const std::vector<Finding>& check(sf::Time now);
+
+    // Time of the last sampled press of the key, if it happened after the given time
+    std::optional<sf::Time> getPressSince(sf::Keyboard::Scancode scancode, sf::Time since) const;
+
+private:
+    static constexpr auto inputCount = InputSnapshot::inputCount;
+
+    struct Sampled
+    {
+        bool     pressed = false;
+        sf::Time lastPress;
+        sf::Time lastRelease;
+    };
+
+    struct Reported
+    {
+        bool     pressed = false;
+        sf::Time changedAt;
+        bool     unchecked = false; // the last event has not been compared to the samples yet
+        sf::Time flaggedSample;     // last sampled change which was reported, so it is only reported once
+    };
+
+    const sf::Time m_period;
+    const sf::Time m_tolerance;
+    bool           m_focused = true;
+
+    InputSnapshot                    m_snapshot;
+    sf::Time                         m_next; // of the next sample
+    std::array<Sampled, inputCount>  m_sampled;
+    std::array<Reported, inputCount> m_reported;
+    std::vector<Finding>             m_findings;
+};
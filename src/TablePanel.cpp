@@ -0,0 +1,170 @@
+#include "TablePanel.hpp"
+
+#include <algorithm>
+
+TablePanel::TablePanel(Animator& animator, GlyphCache& glyphs, std::u32string_view text, float lineSize) :
+m_animator{animator},
+m_glyphs{glyphs},
+m_lineSize{lineSize}
+{
+    setText(text);
+}
+
+void TablePanel::setText(std::u32string_view text)
+{
+    auto row    = std::size_t{0};
+    auto column = std::size_t{0};
+    for (std::size_t begin = 0, end = 0; begin <= text.size(); begin = end + 1)
+    {
+        end = std::min(text.find_first_of(U"\t\n", begin), text.size());
+        if (end != begin)
+            setCell(row, column++, text.substr(begin, end - begin));
+
+        if (end < text.size() && text[end] == U'\n')
+        {
+            // Empty rows count too, the text may end with some
+            if (row >= m_rows.size())
+                m_rows.resize(row + 1);
+            if (m_rows[row].used != column)
+            {
+                m_rows[row].used = column;
+                m_changed        = true;
+            }
+            ++row;
+            column = 0;
+        }
+    }
+
+    // The last row is not terminated by a new line
+    if (column != 0)
+    {
+        if (m_rows[row].used != column)
+        {
+            m_rows[row].used = column;
+            m_changed        = true;
+        }
+        ++row;
+    }
+
+    for (auto i = row; i < m_usedRows; ++i)
+        m_rows[i].used = 0;
+    m_changed |= m_usedRows != row;
+    m_usedRows = row;
+
+    if (m_changed)
+        rebuild();
+}
+
+void TablePanel::shine(const sf::Color& color)
+{
+    m_outlineColor = color;
+    m_animator.start(*this, 0, m_duration);
+}
+
+std::uint32_t TablePanel::getRevision() const
+{
+    return m_revision;
+}
+
+void TablePanel::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    states.transform *= getTransform();
+    states.texture = &m_glyphs.getTexture();
+    target.draw(m_vertices.data(), m_vertices.size(), sf::PrimitiveType::Triangles, states);
+}
+
+void TablePanel::animate(std::size_t /* channel */, float progress)
+{
+    const float ratio = 1.f - progress;
+    const float alpha = ratio * (2.f - ratio) * 0.5f;
+
+    m_outlineColor.a = static_cast<std::uint8_t>(255 * alpha);
+    for (std::size_t i = 0; i < m_outlineCount; ++i)
+        m_vertices[i].color = m_outlineColor;
+    ++m_revision;
+}
+
+void TablePanel::setCell(std::size_t row, std::size_t column, std::u32string_view text)
+{
+    if (row >= m_rows.size())
+        m_rows.resize(row + 1);
+
+    auto& cells = m_rows[row].cells;
+    if (column >= cells.size())
+        cells.resize(column + 1);
+
+    auto&      cell = cells[column];
+    const auto used = row < m_usedRows && column < m_rows[row].used;
+    if (used && cell.text == text)
+        return;
+
+    // A cell of the same size is written over, the others move and need the table to be laid out again
+    const auto& fragment = m_glyphs.get(text);
+    const auto  resized  = !used || cell.width != fragment.width || cell.fill.size() != fragment.fill.size() ||
+                         cell.outline.size() != fragment.outline.size();
+
+    cell.text.assign(text);
+    cell.fill.assign(fragment.fill.begin(), fragment.fill.end());
+    cell.outline.assign(fragment.outline.begin(), fragment.outline.end());
+    cell.width = fragment.width;
+
+    if (resized)
+    {
+        m_changed = true;
+    }
+    else
+    {
+        rewrite(cell);
+        ++m_revision;
+    }
+}
+
+void TablePanel::rewrite(const Cell& cell)
+{
+    for (std::size_t i = 0; i < cell.outline.size(); ++i)
+    {
+        auto& vertex     = m_vertices[cell.outlineOffset + i];
+        vertex.position  = cell.outline[i].position + cell.position;
+        vertex.texCoords = cell.outline[i].texCoords;
+    }
+    for (std::size_t i = 0; i < cell.fill.size(); ++i)
+    {
+        auto& vertex     = m_vertices[cell.fillOffset + i];
+        vertex.position  = cell.fill[i].position + cell.position;
+        vertex.texCoords = cell.fill[i].texCoords;
+    }
+}
+
+void TablePanel::rebuild()
+{
+    m_vertices.clear();
+
+    const auto append = [this](bool outline)
+    {
+        for (std::size_t row = 0; row < m_usedRows; ++row)
+        {
+            auto x = -columnGap;
+            for (std::size_t column = 0; column < m_rows[row].used; ++column)
+            {
+                auto& cell = m_rows[row].cells[column];
+                x          = std::max(x + columnGap, column < columns.size() ? columns[column] : 0.f);
+
+                cell.position = {x, static_cast<float>(row) * m_lineSize};
+                (outline ? cell.outlineOffset : cell.fillOffset) = m_vertices.size();
+
+                const auto color = outline ? m_outlineColor : sf::Color::White;
+                for (const auto& vertex : outline ? cell.outline : cell.fill)
+                    m_vertices.push_back({vertex.position + cell.position, color, vertex.texCoords});
+
+                x += cell.width;
+            }
+        }
+    };
+
+    append(true);
+    m_outlineCount = m_vertices.size();
+    append(false);
+
+    m_changed = false;
+    ++m_revision;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Animator.hpp"
+#include "GlyphCache.hpp"
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Transformable.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <cstdint>
+
+// Description panel drawn as a table, lines are rows and tabs separate cells which start at fixed columns, consecutive
+// tabs count as one so that the texts stay aligned in the console too
+class TablePanel : public sf::Drawable, public sf::Transformable, public Animated
+{
+public:
+    TablePanel(Animator& animator, GlyphCache& glyphs, std::u32string_view text, float lineSize);
+
+    // Only the cells whose text changed are written again, in place unless their size changed
+    void setText(std::u32string_view text);
+
+    // The outline glows and fades out
+    void shine(const sf::Color& color = sf::Color::Yellow);
+
+    // Changes whenever the panel looks different
+    std::uint32_t getRevision() const;
+
+private:
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    void animate(std::size_t channel, float progress) override;
+
+    void setCell(std::size_t row, std::size_t column, std::u32string_view text);
+    void rebuild();
+
+    // Left edges of the cells, a cell which doesn't fit pushes the next ones to the right
+    static constexpr std::array<float, 3> columns   = {0.f, 100.f, 150.f};
+    static constexpr float                columnGap = 12.f;
+
+    static inline const sf::Time m_duration = sf::milliseconds(150);
+
+    struct Cell
+    {
+        std::u32string          text;
+        std::vector<sf::Vertex> fill, outline;
+        float                   width = 0.f;
+
+        // Where the last rebuild placed the cell, valid while it is used
+        sf::Vector2f position;
+        std::size_t  outlineOffset = 0, fillOffset = 0;
+    };
+
+    // Cells past the used ones keep their memory for the next texts
+    struct Row
+    {
+        std::vector<Cell> cells;
+        std::size_t       used = 0;
+    };
+
+    // Writes the vertices of a used cell where the last rebuild placed them
+    void rewrite(const Cell& cell);
+
+    Animator&   m_animator;
+    GlyphCache& m_glyphs;
+    const float m_lineSize;
+
+    std::vector<Row> m_rows;
+    std::size_t      m_usedRows = 0;
+    bool             m_changed  = false;
+
+    std::vector<sf::Vertex> m_vertices; // outlines first, so that they stay behind every glyph
+    std::size_t             m_outlineCount = 0;
+    sf::Color               m_outlineColor = sf::Color::Transparent;
+    std::uint32_t           m_revision     = 0;
+};
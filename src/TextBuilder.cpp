@@ -0,0 +1,81 @@
+#include "TextBuilder.hpp"
+
+#include "strings.hpp"
+
+#include <charconv>
+
+namespace
+{
+// Typical length of a panel, so that most texts never grow their buffer
+constexpr std::size_t initialCapacity = 256;
+
+} // namespace
+
+TextBuilder::TextBuilder(FrameArena& arena) : m_text{ArenaAllocator<char32_t>{arena}}
+{
+    m_text.reserve(initialCapacity);
+}
+
+TextBuilder& TextBuilder::operator+=(const char* text)
+{
+    return *this += std::string_view{text};
+}
+
+TextBuilder& TextBuilder::operator+=(std::string_view text)
+{
+    for (const auto character : text)
+        m_text += static_cast<char32_t>(static_cast<unsigned char>(character));
+    return *this;
+}
+
+TextBuilder& TextBuilder::operator+=(const sf::String& text)
+{
+    m_text.append(text.getData(), text.getSize());
+    return *this;
+}
+
+TextBuilder& TextBuilder::operator+=(char32_t character)
+{
+    m_text += character;
+    return *this;
+}
+
+std::u32string_view TextBuilder::view() const
+{
+    return {m_text.data(), m_text.size()};
+}
+
+void TextBuilder::copyTo(std::u32string& string) const
+{
+    string.assign(m_text.data(), m_text.size());
+}
+
+void TextBuilder::copyTo(sf::String& string) const
+{
+    // sf::String can't be assigned from a range without a temporary, but single characters fit in place
+    string.clear();
+    for (const auto character : m_text)
+        string += character;
+}
+
+TextBuilder& TextBuilder::appendNumber(long long number)
+{
+    char digits[24];
+    const auto [end, error] = std::to_chars(digits, digits + sizeof(digits), number);
+    return *this += std::string_view{digits, static_cast<std::size_t>(end - digits)};
+}
+
+bool setText(sf::Text& text, std::u32string_view string)
+{
+    if (toView(text.getString()) == string)
+        return false;
+
+    // Kept from one call to the next, so that its capacity is allocated only once
+    static thread_local auto buffer = sf::String{};
+    buffer.clear();
+    for (const auto character : string)
+        buffer += character;
+    text.setString(buffer);
+
+    return true;
+}
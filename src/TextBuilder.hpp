@@ -0,0 +1,48 @@
+#pragma once
+
+#include "FrameArena.hpp"
+
+#include <SFML/Graphics/Text.hpp>
+
+#include <SFML/System/String.hpp>
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Builds the text of the panels and of the console output in the memory of the current frame,
+// appending numbers and identifiers without any temporary string
+class TextBuilder
+{
+public:
+    explicit TextBuilder(FrameArena& arena);
+
+    // Text is ASCII, as the literals and the identifiers are
+    TextBuilder& operator+=(const char* text);
+    TextBuilder& operator+=(std::string_view text);
+    TextBuilder& operator+=(const sf::String& text);
+    TextBuilder& operator+=(char32_t character);
+
+    template <typename Integer,
+              std::enable_if_t<std::is_integral_v<Integer> && !std::is_same_v<Integer, char32_t> &&
+                                   !std::is_same_v<Integer, char> && !std::is_same_v<Integer, bool>,
+                               int> = 0>
+    TextBuilder& operator+=(Integer number)
+    {
+        return appendNumber(static_cast<long long>(number));
+    }
+
+    std::u32string_view view() const;
+
+    // Keep the capacity of the destination, so that texts of similar lengths are copied without allocating
+    void copyTo(std::u32string& string) const;
+    void copyTo(sf::String& string) const;
+
+private:
+    TextBuilder& appendNumber(long long number);
+
+    std::basic_string<char32_t, std::char_traits<char32_t>, ArenaAllocator<char32_t>> m_text;
+};
+
+// Only lays the text out again if it changed, returns whether it did
+bool setText(sf::Text& text, std::u32string_view string);
@@ -0,0 +1,115 @@
+#include "TextCorrelator.hpp"
+
+#include <utility>
+
+namespace
+{
+// Dead keys and compose sequences can leave presses without text for a while
+constexpr auto textTimeout = sf::seconds(1.f);
+
+// Several characters from one press, e.g. a dead key followed by a key it doesn't combine with
+constexpr auto extraTextWindow = sf::milliseconds(50);
+
+constexpr std::size_t maxPending = 8;
+
+bool isModifier(sf::Keyboard::Scancode scancode)
+{
+    switch (scancode)
+    {
+        case sf::Keyboard::Scan::LShift:
+        case sf::Keyboard::Scan::RShift:
+        case sf::Keyboard::Scan::LControl:
+        case sf::Keyboard::Scan::RControl:
+        case sf::Keyboard::Scan::LAlt:
+        case sf::Keyboard::Scan::RAlt:
+        case sf::Keyboard::Scan::LSystem:
+        case sf::Keyboard::Scan::RSystem:
+        case sf::Keyboard::Scan::CapsLock:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+TextCorrelator::TextCorrelator()
+{
+    m_pending.reserve(maxPending);
+    m_lastPaired.timestamp = -extraTextWindow.asMicroseconds() - 1;
+}
+
+void TextCorrelator::handle(const sf::Event& event, EventRecord& record)
+{
+    if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>())
+    {
+        if (keyPressed->scancode == sf::Keyboard::Scan::Unknown || isModifier(keyPressed->scancode))
+            return;
+
+        if (m_pending.size() == maxPending)
+            m_pending.erase(m_pending.begin());
+        m_pending.push_back({record, keyPressed->control || keyPressed->alt || keyPressed->system});
+    }
+    else if (event.is<sf::Event::TextEntered>())
+    {
+        if (m_pending.empty())
+        {
+            // Either another character of the last press or text which comes from somewhere else
+            if (record.timestamp - m_lastPaired.timestamp <= extraTextWindow.asMicroseconds())
+            {
+                record.scancode = m_lastPaired.scancode;
+                record.latency  = static_cast<std::int32_t>(record.timestamp - m_lastPaired.timestamp);
+            }
+            else
+            {
+                record.flags |= EventRecord::TextWithoutPress;
+            }
+
+            return;
+        }
+
+        // The text comes from the last press, possibly combined with the ones before
+        const auto& press = m_pending.back().record;
+        auto&       text  = m_text[static_cast<sf::Keyboard::Scancode>(press.scancode)];
+        record.scancode   = press.scancode;
+        record.latency    = static_cast<std::int32_t>(record.timestamp - press.timestamp);
+
+        if (m_pending.size() > 1 && text != record.unicode)
+            record.flags |= EventRecord::Composed;
+        else
+            for (auto it = m_pending.begin(); it + 1 != m_pending.end(); ++it)
+                addMissingText(*it);
+
+        if (m_pending.size() == 1)
+            text = record.unicode;
+
+        m_lastPaired = press;
+        m_pending.clear();
+    }
+}
+
+const std::vector<EventRecord>& TextCorrelator::expire(sf::Time now)
+{
+    const auto deadline = (now - textTimeout).asMicroseconds();
+
+    auto expired = m_pending.begin();
+    while (expired != m_pending.end() && expired->record.timestamp < deadline)
+        addMissingText(*expired++);
+    m_pending.erase(m_pending.begin(), expired);
+
+    // Also return the presses found without text while handling events since the last call
+    m_reported.clear();
+    std::swap(m_reported, m_missing);
+
+    return m_reported;
+}
+
+void TextCorrelator::addMissingText(const Press& press)
+{
+    // Only keys which produced text before are expected to, dead keys and navigation keys never do
+    if (press.modified || m_text[static_cast<sf::Keyboard::Scancode>(press.record.scancode)] == 0)
+        return;
+
+    auto& missing = m_missing.emplace_back(press.record);
+    missing.type  = EventRecord::Type::MissingText;
+}
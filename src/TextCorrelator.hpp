@@ -0,0 +1,41 @@
+#pragma once
+
+#include "EventRecord.hpp"
+#include "ranges.hpp"
+
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Keyboard.hpp>
+
+#include <SFML/System/Time.hpp>
+
+#include <vector>
+
+// Pairs each TextEntered event with the KeyPressed event which produced it
+class TextCorrelator
+{
+public:
+    TextCorrelator();
+
+    // Fills the scancode, latency and flags of text records
+    void handle(const sf::Event& event, EventRecord& record);
+
+    // Presses which should have produced text by now, as MissingText records
+    const std::vector<EventRecord>& expire(sf::Time now);
+
+private:
+    struct Press
+    {
+        EventRecord record;
+        bool        modified; // Control, Alt or System held, which usually prevents text
+    };
+
+    void addMissingText(const Press& press);
+
+    std::vector<Press>       m_pending; // presses since the last text, oldest first
+    std::vector<EventRecord> m_missing;  // since the last call to expire
+    std::vector<EventRecord> m_reported; // returned by expire
+    EventRecord              m_lastPaired;
+
+    // Last character each key produced on its own, 0 if it never did
+    EnumMap<sf::Keyboard::Scancode, char32_t> m_text;
+};
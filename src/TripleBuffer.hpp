@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include <cstdint>
+
+// Hands the latest complete value from one writing thread to one reading thread without locks. The writer fills the
+// back buffer and swaps it with the middle one, the reader swaps its front buffer with the middle one when that is
+// newer, so neither ever waits and the values the reader was too slow for are skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+    explicit TripleBuffer(const T& value) : m_buffers{value, value, value}
+    {
+    }
+
+    // Of the writer, it holds an older value which is to be overwritten completely
+    T& back()
+    {
+        return m_buffers[m_back];
+    }
+
+    void publish()
+    {
+        m_back = m_middle.exchange(m_back | fresh, std::memory_order_acq_rel) & index;
+    }
+
+    // Returns false if nothing was published since the last call, the front buffer is left as it is then
+    bool acquire()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & fresh) == 0)
+            return false;
+
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & index;
+        return true;
+    }
+
+    // Of the reader
+    const T& front() const
+    {
+        return m_buffers[m_front];
+    }
+
+private:
+    static constexpr std::uint8_t index = 3;
+    static constexpr std::uint8_t fresh = 4; // set in the middle index by the writer, cleared by the reader
+
+    std::array<T, 3>          m_buffers;
+    std::uint8_t              m_back  = 0;
+    std::uint8_t              m_front = 1;
+    std::atomic<std::uint8_t> m_middle{2};
+};
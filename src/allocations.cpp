@@ -0,0 +1,95 @@
+#include "allocations.hpp"
+
+#include <atomic>
+#include <new>
+
+#include <cstdlib>
+
+namespace
+{
+// Per thread, so that the audio, evdev and render threads don't show up in the frames of the event thread
+thread_local std::uint64_t allocationCount = 0;
+
+// Shared by all threads, leaks show up as a count which keeps growing
+std::atomic<std::int64_t> liveAllocationCount{0};
+
+void* allocate(std::size_t size)
+{
+    ++allocationCount;
+    auto* pointer = std::malloc(size != 0 ? size : 1);
+    if (pointer)
+        liveAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    return pointer;
+}
+
+void deallocate(void* pointer)
+{
+    if (pointer)
+        liveAllocationCount.fetch_sub(1, std::memory_order_relaxed);
+    std::free(pointer);
+}
+
+} // namespace
+
+std::uint64_t getAllocationCount()
+{
+    return allocationCount;
+}
+
+std::int64_t getLiveAllocationCount()
+{
+    return liveAllocationCount.load(std::memory_order_relaxed);
+}
+
+// The aligned overloads are left alone, they are rare and keep working with their own deallocation functions
+void* operator new(std::size_t size)
+{
+    if (auto* pointer = allocate(size))
+        return pointer;
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocations made by the calling thread so far, counted by the replaced global operator new
+std::uint64_t getAllocationCount();
+
+// Allocations of all threads through the replaced global operator new which were not freed yet
+std::int64_t getLiveAllocationCount();
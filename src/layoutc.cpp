@@ -0,0 +1,62 @@
+#include "KeyboardLayout.hpp"
+#include "strings.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Compiles the layout files given as arguments into a source file defining getBuiltinLayouts, run by the build
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " OUTPUT LAYOUT...\n";
+
+        return 1;
+    }
+
+    auto layouts = std::vector<KeyboardLayout>{};
+    for (int i = 2; i < argc; ++i)
+    {
+        auto error  = std::string{};
+        auto layout = loadLayout(argv[i], error);
+        if (!layout)
+        {
+            std::cout << "Error: " << error << '\n';
+
+            return 1;
+        }
+        layouts.push_back(std::move(*layout));
+    }
+
+    auto os = std::ofstream{argv[1]};
+    os << std::fixed << std::setprecision(2);
+    os << "// Generated from resources/layouts by SFML-Input-LayoutCompiler, edit the layout files instead\n\n"
+       << "#include \"KeyboardLayout.hpp\"\n\n"
+       << "#include <iterator>\n\n"
+       << "namespace\n{\n";
+
+    for (std::size_t i = 0; i < layouts.size(); ++i)
+    {
+        os << "constexpr KeyboardLayout::Cell layout" << i << "[] = {\n";
+        for (const auto& cell : layouts[i].cells)
+            os << "    {sf::Keyboard::" << scancodeIdentifier(cell.scancode) << ", {{" << cell.rect.position.x << "f, "
+               << cell.rect.position.y << "f}, {" << cell.rect.size.x << "f, " << cell.rect.size.y << "f}}, {"
+               << cell.labelCenter.x << "f, " << cell.labelCenter.y << "f}, " << cell.labelWidth << "f, "
+               << cell.vertexOffset << "},\n";
+        os << "};\n\n";
+    }
+
+    os << "} // namespace\n\n"
+       << "const std::vector<KeyboardLayout>& getBuiltinLayouts()\n{\n"
+       << "    static const auto layouts = std::vector<KeyboardLayout>{\n";
+    for (std::size_t i = 0; i < layouts.size(); ++i)
+        os << "        {\"" << layouts[i].name << "\", {std::begin(layout" << i << "), std::end(layout" << i
+           << ")}, {" << layouts[i].size.x << "f, " << layouts[i].size.y << "f}},\n";
+    os << "    };\n\n"
+       << "    return layouts;\n"
+       << "}\n";
+
+    return os ? 0 : 1;
+}
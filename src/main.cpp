@@ -1,20 +1,48 @@
 #include "Application.hpp"
+#include "profiler.hpp"
 #include "ranges.hpp"
 #include "strings.hpp"
 
 #include <SFML/Window/Keyboard.hpp>
 
+#include <charconv>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <optional>
+
+#include <cstring>
 
 namespace
 {
 constexpr auto help =
-    "  -v, --verbose   Show more information\n"
-    "  -d, --dot       Generate dot diagram about localize and delocalize functions\n"
-    "  -u, --utf8      Encode console output as UTF-8 instead of ANSI\n"
-    "  -h, --help      Show help and exit";
+    "  -v, --verbose       Show more information\n"
+    "  -d, --dot           Generate dot diagram about localize and delocalize functions\n"
+    "  -u, --utf8          Encode console output as UTF-8 instead of ANSI\n"
+    "  -p, --profile       Measure the cost of the platform keyboard functions for every key and scancode\n"
+    "  -s, --sample N      Sample the key and button state N times per second (1 to 1000) and check it against events\n"
+    "  -m, --heatmap       Color the keyboard by how often each key was pressed\n"
+    "  -r, --rollover      Run the guided key rollover and ghosting test, results are written to rollover.txt\n"
+    "  -l, --log FILE      Write every event to FILE as one line of JSON\n"
+    "  -a, --archive FILE  Write every event to FILE in the compact format read by SFML-Input-Query\n"
+    "  --shm NAME          Publish the key and button state and recent events as shared memory NAME\n"
+    "  --socket PATH       Stream every event as one line of JSON to the clients of Unix domain socket PATH\n"
+    "  --soak FILE         Sample throughput, frame times and resource usage every minute into FILE, typing by itself\n"
+    "                      after 30 s without input\n"
+    "  -c, --capture N,M   Write N frames before and M frames after anomalies to captures/ as PNG files\n"
+    "  --patterns FILE     Report the chords and key sequences of FILE as they are typed, or missed, see\n"
+    "                      resources/patterns/shortcuts.patterns\n"
+    "  --mute              Don't initialize audio and play no sounds\n"
+    "  --evdev             Also read the keyboards and mice of /dev/input to measure the latency of the display\n"
+    "                      server, Linux only, usually requires membership in the input group\n"
+    "  --evdev-record FILE Write the events read from /dev/input to FILE, implies --evdev\n"
+    "  --evdev-replay FILE Replay the events of FILE instead of reading /dev/input\n"
+    "  --pipelined         Draw the frames from a thread of their own while events are handled, always done with\n"
+    "                      another pacing than deadline\n"
+    "  --pacing MODE       Pace the frames by deadline (default), fixed, vsync or uncapped, click the Frame Pacing\n"
+    "                      panel to switch while running\n"
+    "  -k, --layout NAME   Draw the keyboard as ansi, iso, jis, tkl, compact, full (default) or from a layout file\n"
+    "  -h, --help          Show help and exit";
 
 struct Arguments
 {
@@ -23,9 +51,31 @@ struct Arguments
     bool verbose         = false;
     bool generateDiagram = false;
     bool utf8            = false;
+    bool profile         = false;
+    bool heatmap         = false;
+    bool rolloverTest    = false;
+    bool mute            = false;
+    bool pipelined       = false;
+    bool evdev           = false;
     bool help            = false;
+
+    unsigned int samplingRate  = 0;
+    unsigned int captureBefore = 0;
+    unsigned int captureAfter  = 0;
+    std::string  logPath;
+    std::string  archivePath;
+    std::string  sharedMemoryName;
+    std::string  socketPath;
+    std::string  soakPath;
+    std::string  patternsPath;
+    std::string  evdevRecordPath;
+    std::string  evdevReplayPath;
+    std::string  layout = "full";
+    Pacing       pacing = Pacing::Deadline;
 };
 
+std::optional<KeyboardLayout> findLayout(const std::string& nameOrPath);
+
 void printScancodeDescriptions(std::ostream& os, Encoder encode);
 void printLocalizeAndDelocalizeOddities(std::ostream& os);
 void printLocalizeAndDelocalizeDiagram(std::ostream& os);
@@ -56,15 +106,65 @@ int main(int argc, char* argv[])
         printLocalizeAndDelocalizeDiagram(ofs);
     }
 
+    // Show how expensive the sf::Keyboard functions are on this display server
+    if (args.profile)
+        printPlatformCallCosts(std::cout);
+
     // Check events and sf::Keyboard::isPressed behavior interactively
-    if (auto resources = Resources{}; resources.open("resources"))
-        return Application{resources, encode}.run();
+    auto settings             = Settings{};
+    settings.samplingRate     = args.samplingRate;
+    settings.heatmap          = args.heatmap;
+    settings.rolloverTest     = args.rolloverTest;
+    settings.mute             = args.mute;
+    settings.pipelined        = args.pipelined;
+    settings.pacing           = args.pacing;
+    settings.evdev            = args.evdev || !args.evdevRecordPath.empty();
+    settings.evdevRecordPath  = args.evdevRecordPath;
+    settings.evdevReplayPath  = args.evdevReplayPath;
+    settings.logPath          = args.logPath;
+    settings.archivePath      = args.archivePath;
+    settings.sharedMemoryName = args.sharedMemoryName;
+    settings.socketPath       = args.socketPath;
+    settings.soakPath         = args.soakPath;
+    settings.captureBefore    = args.captureBefore;
+    settings.captureAfter     = args.captureAfter;
+
+    if (auto layout = findLayout(args.layout))
+        settings.keyboardLayout = std::move(*layout);
+    else
+        return 1;
+
+    if (!args.patternsPath.empty())
+    {
+        auto error    = std::string{};
+        auto patterns = loadPatterns(args.patternsPath, error);
+        if (!patterns)
+        {
+            std::cout << "Error: " << error << '\n';
+            return 1;
+        }
+        settings.patterns = std::move(*patterns);
+    }
+
+    if (auto resources = Resources{}; resources.open("resources", !args.mute))
+        return Application{resources, encode, settings}.run();
     else
         return 1;
 }
 
 namespace
 {
+// Returns 0 if the argument is not a number between min and max
+unsigned int parseNumber(const char* argument, unsigned int min, unsigned int max)
+{
+    auto       number = 0u;
+    const auto end    = argument + std::strlen(argument);
+    if (const auto [ptr, error] = std::from_chars(argument, end, number); error != std::errc{} || ptr != end)
+        return 0;
+
+    return min <= number && number <= max ? number : 0;
+}
+
 Arguments::Arguments(int argc, char* argv[])
 {
     for (int i = 1; i < argc; i++)
@@ -79,6 +179,69 @@ Arguments::Arguments(int argc, char* argv[])
             generateDiagram = true;
         else if (arg == "-u" || arg == "--utf8")
             utf8 = true;
+        else if (arg == "-p" || arg == "--profile")
+            profile = true;
+        else if (arg == "-m" || arg == "--heatmap")
+            heatmap = true;
+        else if (arg == "-r" || arg == "--rollover")
+            rolloverTest = true;
+        else if (arg == "--mute")
+            mute = true;
+        else if (arg == "--pipelined")
+            pipelined = true;
+        else if (arg == "--evdev")
+            evdev = true;
+        else if (arg == "--evdev-record" && i + 1 < argc)
+            evdevRecordPath = argv[++i];
+        else if (arg == "--evdev-replay" && i + 1 < argc)
+            evdevReplayPath = argv[++i];
+        else if ((arg == "-l" || arg == "--log") && i + 1 < argc)
+            logPath = argv[++i];
+        else if ((arg == "-a" || arg == "--archive") && i + 1 < argc)
+            archivePath = argv[++i];
+        else if (arg == "--shm" && i + 1 < argc)
+            sharedMemoryName = argv[++i];
+        else if (arg == "--socket" && i + 1 < argc)
+            socketPath = argv[++i];
+        else if (arg == "--soak" && i + 1 < argc)
+            soakPath = argv[++i];
+        else if (arg == "--patterns" && i + 1 < argc)
+            patternsPath = argv[++i];
+        else if ((arg == "-k" || arg == "--layout") && i + 1 < argc)
+            layout = argv[++i];
+        else if ((arg == "-c" || arg == "--capture") && i + 1 < argc)
+        {
+            const auto frames = std::string{argv[++i]};
+            const auto comma  = frames.find(',');
+            captureBefore     = parseNumber(frames.substr(0, comma).c_str(), 1, 300);
+            captureAfter      = comma != std::string::npos ? parseNumber(frames.c_str() + comma + 1, 1, 300) : 0;
+            if (captureBefore == 0 || captureAfter == 0)
+            {
+                help = true;
+                std::cout << "Error: invalid capture frames " << frames << '\n';
+            }
+        }
+        else if (arg == "--pacing" && i + 1 < argc)
+        {
+            if (const auto parsed = parsePacing(argv[++i]))
+            {
+                pacing = *parsed;
+            }
+            else
+            {
+                help = true;
+                std::cout << "Error: invalid pacing " << argv[i] << '\n';
+            }
+        }
+        else if ((arg == "-s" || arg == "--sample") && i + 1 < argc)
+        {
+            samplingRate = parseNumber(argv[++i], 1, 1000);
+            if (samplingRate == 0)
+            {
+                help = true;
+                std::cout << "Error: invalid sampling rate " << argv[i] << '\n';
+            }
+        }
         else
         {
             help = true;
@@ -87,6 +250,20 @@ Arguments::Arguments(int argc, char* argv[])
     }
 }
 
+std::optional<KeyboardLayout> findLayout(const std::string& nameOrPath)
+{
+    for (const auto& layout : getBuiltinLayouts())
+        if (layout.name == nameOrPath)
+            return layout;
+
+    auto error  = std::string{};
+    auto layout = loadLayout(nameOrPath, error);
+    if (!layout)
+        std::cout << "Error: " << error << '\n';
+
+    return layout;
+}
+
 std::ostream& operator<<(std::ostream& os, sf::Keyboard::Key code)
 {
     return os << keyIdentifier(code);
@@ -101,8 +278,12 @@ void printScancodeDescriptions(std::ostream& os, Encoder encode)
 {
     os << "\tScancode descriptions\n\n";
     for (auto scancode : scancodes)
+    {
         os << std::right << std::setw(3) << static_cast<int>(scancode) << ' ' << std::left << std::setw(24) << scancode
-           << ' ' << encode(sf::Keyboard::getDescription(scancode)) << '\n';
+           << ' ';
+        encode(os, toView(sf::Keyboard::getDescription(scancode)));
+        os << '\n';
+    }
     os << '\n';
 }
 
@@ -152,15 +333,15 @@ void printLocalizeAndDelocalizeOddities(std::ostream& os)
 
 void printLocalizeAndDelocalizeDiagram(std::ostream& os)
 {
-    auto inDegreeScancode = std::array<int, sf::Keyboard::ScancodeCount>{};
+    auto inDegreeScancode = EnumMap<sf::Keyboard::Scancode, int>{};
     for (auto key : keys)
         if (auto scancode = sf::Keyboard::delocalize(key); scancode != sf::Keyboard::Scan::Unknown)
-            inDegreeScancode[static_cast<std::size_t>(scancode)]++;
+            inDegreeScancode[scancode]++;
 
-    auto inDegreeKey = std::array<int, sf::Keyboard::KeyCount>{};
+    auto inDegreeKey = EnumMap<sf::Keyboard::Key, int>{};
     for (auto scancode : scancodes)
         if (auto key = sf::Keyboard::localize(scancode); key != sf::Keyboard::Key::Unknown)
-            inDegreeKey[static_cast<std::size_t>(key)]++;
+            inDegreeKey[key]++;
 
     os << "digraph {\n"
        << "rankdir=LR\n"
@@ -170,8 +351,7 @@ void printLocalizeAndDelocalizeDiagram(std::ostream& os)
         if (auto scancode = sf::Keyboard::delocalize(key); scancode != sf::Keyboard::Scan::Unknown)
         {
             auto key2 = sf::Keyboard::localize(scancode);
-            if (inDegreeScancode[static_cast<int>(scancode)] != 1 || inDegreeKey[static_cast<std::size_t>(key)] != 1 ||
-                key != key2)
+            if (inDegreeScancode[scancode] != 1 || inDegreeKey[key] != 1 || key != key2)
                 os << '"' << key << "\" -> \"" << scancode << "\"\n";
         }
         else
@@ -183,8 +363,7 @@ void printLocalizeAndDelocalizeDiagram(std::ostream& os)
         if (auto key = sf::Keyboard::localize(scancode); key != sf::Keyboard::Key::Unknown)
         {
             auto scancode2 = sf::Keyboard::delocalize(key);
-            if (inDegreeKey[static_cast<std::size_t>(key)] != 1 || inDegreeScancode[static_cast<int>(scancode)] != 1 ||
-                scancode != scancode2)
+            if (inDegreeKey[key] != 1 || inDegreeScancode[scancode] != 1 || scancode != scancode2)
                 os << '"' << key << "\" -> \"" << scancode << "\" [dir=back]\n";
         }
         else
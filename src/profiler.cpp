@@ -0,0 +1,163 @@
+#include "profiler.hpp"
+
+#include "ranges.hpp"
+#include "strings.hpp"
+
+#include <SFML/Window/Keyboard.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace
+{
+using Clock       = std::chrono::steady_clock;
+using Nanoseconds = Clock::rep;
+
+constexpr auto repetitions   = 32;
+constexpr auto outlierFactor = 4;
+
+struct Sample
+{
+    std::string argument;
+    Nanoseconds median;
+};
+
+struct CallCost
+{
+    std::string              call;
+    std::vector<Nanoseconds> latencies; // every measured call
+    std::vector<Sample>      samples;   // median latency per argument
+};
+
+// Keep the compiler from optimizing away the calls being measured
+volatile std::size_t sink;
+
+void consume(bool value)
+{
+    sink = sink + value;
+}
+
+void consume(sf::Keyboard::Key key)
+{
+    sink = sink + static_cast<std::size_t>(key);
+}
+
+void consume(sf::Keyboard::Scancode scancode)
+{
+    sink = sink + static_cast<std::size_t>(scancode);
+}
+
+void consume(const sf::String& string)
+{
+    sink = sink + string.getSize();
+}
+
+template <typename Call>
+Nanoseconds timeCall(Call call)
+{
+    const auto start = Clock::now();
+    consume(call());
+    const auto stop = Clock::now();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+}
+
+Nanoseconds median(std::array<Nanoseconds, repetitions> latencies)
+{
+    std::nth_element(latencies.begin(), latencies.begin() + repetitions / 2, latencies.end());
+    return latencies[repetitions / 2];
+}
+
+template <typename Range, typename Identify, typename Call>
+CallCost measure(std::string call, const Range& range, Identify identify, Call callee, Nanoseconds overhead)
+{
+    auto cost      = CallCost{std::move(call), {}, {}};
+    auto latencies = std::array<Nanoseconds, repetitions>{};
+    for (auto value : range)
+    {
+        for (auto& latency : latencies)
+            latency = std::max(Nanoseconds{0}, timeCall([&] { return callee(value); }) - overhead);
+
+        cost.latencies.insert(cost.latencies.end(), latencies.begin(), latencies.end());
+        cost.samples.push_back({identify(value), median(latencies)});
+    }
+    std::sort(cost.latencies.begin(), cost.latencies.end());
+
+    return cost;
+}
+
+Nanoseconds percentile(const std::vector<Nanoseconds>& sorted, int percent)
+{
+    return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+} // namespace
+
+void printPlatformCallCosts(std::ostream& os)
+{
+    // Cost of reading the clock twice, subtracted from every measurement
+    auto overheads = std::array<Nanoseconds, repetitions>{};
+    for (auto& overhead : overheads)
+        overhead = timeCall([] { return false; });
+    const auto overhead = median(overheads);
+
+    const auto keyName      = [](sf::Keyboard::Key key) { return std::string{keyIdentifier(key)}; };
+    const auto scancodeName = [](sf::Keyboard::Scancode scancode) { return std::string{scancodeIdentifier(scancode)}; };
+
+    const auto costs = std::array{
+        measure("isKeyPressed(Key)",
+                keys,
+                keyName,
+                [](auto key) { return sf::Keyboard::isKeyPressed(key); },
+                overhead),
+        measure("isKeyPressed(Scancode)",
+                scancodes,
+                scancodeName,
+                [](auto scancode) { return sf::Keyboard::isKeyPressed(scancode); },
+                overhead),
+        measure("localize(Scancode)",
+                scancodes,
+                scancodeName,
+                [](auto scancode) { return sf::Keyboard::localize(scancode); },
+                overhead),
+        measure("delocalize(Key)", keys, keyName, [](auto key) { return sf::Keyboard::delocalize(key); }, overhead),
+        measure("getDescription(Scancode)",
+                scancodes,
+                scancodeName,
+                [](auto scancode) { return sf::Keyboard::getDescription(scancode); },
+                overhead),
+    };
+
+    os << "\tPlatform call costs in nanoseconds (" << repetitions << " calls per argument, timer overhead "
+       << overhead << " ns subtracted)\n\n";
+    os << std::left << std::setw(26) << "call" << std::right << std::setw(10) << "min" << std::setw(10) << "p50"
+       << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "max" << std::setw(14) << "all args"
+       << '\n';
+    for (const auto& [call, latencies, samples] : costs)
+    {
+        // What it costs to call this function once for every key, e.g. once per frame
+        auto fullPass = Nanoseconds{0};
+        for (const auto& sample : samples)
+            fullPass += sample.median;
+
+        os << std::left << std::setw(26) << call << std::right << std::setw(10) << latencies.front() << std::setw(10)
+           << percentile(latencies, 50) << std::setw(10) << percentile(latencies, 90) << std::setw(10)
+           << percentile(latencies, 99) << std::setw(10) << latencies.back() << std::setw(14) << fullPass << '\n';
+    }
+    os << '\n';
+
+    os << "\tArguments for which the median cost is more than " << outlierFactor << " times the call's p50\n\n";
+    for (const auto& [call, latencies, samples] : costs)
+    {
+        const auto threshold = std::max(Nanoseconds{1}, outlierFactor * percentile(latencies, 50));
+        for (const auto& [argument, argumentMedian] : samples)
+            if (threshold < argumentMedian)
+                os << std::left << std::setw(26) << call << std::setw(32) << argument << std::right << std::setw(10)
+                   << argumentMedian << '\n';
+    }
+    os << '\n';
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <ostream>
+
+// Measure how long each sf::Keyboard platform call takes for every key and scancode,
+// print the latency distribution per call and list the keys which are much slower than the others.
+void printPlatformCallCosts(std::ostream& os);
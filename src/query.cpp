@@ -0,0 +1,382 @@
+#include "EventRecord.hpp"
+#include "SessionArchive.hpp"
+#include "ranges.hpp"
+#include "strings.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+constexpr auto help =
+    "Scan the session archives written with --archive, directories are searched for *.events files\n\n"
+    "Filters, events must match all of them:\n"
+    "  --type TYPE         type as in the JSON lines, e.g. KeyPressed, TextEntered or MissingRelease\n"
+    "  --code KEY          sf::Keyboard::Key of key events, e.g. Key::A\n"
+    "  --scancode SCAN     sf::Keyboard::Scancode of key events and the key press of text, e.g. Scan::NonUsBackslash\n"
+    "  --localized KEY     what the scancode localized to\n"
+    "  --delocalized SCAN  what the code delocalized to\n"
+    "  --flag FLAG         Strange, Chatter, Composed, TextWithoutPress or Synthetic\n\n"
+    "Output, by default the number of matching events of each session which has any:\n"
+    "  --count-by COLUMN   count matching events by type, code, scancode, localized, delocalized or flag\n"
+    "  --print             print matching events as JSON lines\n"
+    "  -j, --jobs N        number of files to scan in parallel, by default one per hardware thread\n"
+    "  -h, --help          show help and exit\n\n"
+    "Example, all sessions in which Scan::NonUsBackslash localized to Key::Unknown:\n"
+    "  SFML-Input-Query --type KeyPressed --scancode Scan::NonUsBackslash --localized Key::Unknown captures/";
+
+using Counts = std::map<std::int64_t, std::uint64_t>;
+
+struct CloseFile
+{
+    void operator()(std::FILE* file) const
+    {
+        std::fclose(file);
+    }
+};
+
+using Spool = std::unique_ptr<std::FILE, CloseFile>;
+
+struct Filter
+{
+    std::uint16_t columns() const
+    {
+        auto columns = std::uint16_t{0};
+        columns |= type ? SessionArchive::Type : 0;
+        columns |= code ? SessionArchive::Code : 0;
+        columns |= scancode ? SessionArchive::Scancode : 0;
+        columns |= localized ? SessionArchive::Localized : 0;
+        columns |= delocalized ? SessionArchive::Delocalized : 0;
+        columns |= flags ? SessionArchive::Flags : 0;
+        return columns;
+    }
+
+    bool matches(const EventRecord& record) const
+    {
+        return (!type || record.type == *type) && (!code || record.code == *code) &&
+               (!scancode || record.scancode == *scancode) && (!localized || record.localized == *localized) &&
+               (!delocalized || record.delocalized == *delocalized) && (record.flags & flags) == flags;
+    }
+
+    std::optional<EventRecord::Type> type;
+    std::optional<std::int16_t>      code, scancode, localized, delocalized;
+    std::uint16_t                    flags = 0;
+};
+
+struct Query
+{
+    Filter                             filter;
+    std::optional<std::string>         countBy;
+    bool                               print = false;
+    unsigned int                       jobs  = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::filesystem::path> paths;
+};
+
+struct Result
+{
+    std::uint64_t events = 0, matches = 0;
+    bool          opened = false, corrupt = false;
+    Counts        counts;
+    Spool         printed; // temporary file of the matching events as JSON lines, with --print
+};
+
+SessionArchive::Column countColumn(const std::string& name)
+{
+    static const auto columns = std::map<std::string, SessionArchive::Column>{
+        {"type", SessionArchive::Type},
+        {"code", SessionArchive::Code},
+        {"scancode", SessionArchive::Scancode},
+        {"localized", SessionArchive::Localized},
+        {"delocalized", SessionArchive::Delocalized},
+        {"flag", SessionArchive::Flags},
+    };
+
+    const auto it = columns.find(name);
+    return it != columns.end() ? it->second : SessionArchive::Column{};
+}
+
+std::int64_t countKey(const std::string& countBy, const EventRecord& record)
+{
+    if (countBy == "type")
+        return static_cast<std::int64_t>(record.type);
+    if (countBy == "code")
+        return record.code;
+    if (countBy == "scancode")
+        return record.scancode;
+    if (countBy == "localized")
+        return record.localized;
+    return record.delocalized;
+}
+
+std::string countName(const std::string& countBy, std::int64_t key)
+{
+    if (countBy == "type")
+        return typeName(static_cast<EventRecord::Type>(key));
+    if (countBy == "flag")
+        return flagName(static_cast<std::size_t>(key));
+    if (countBy == "code" || countBy == "localized")
+        return std::string{keyIdentifier(static_cast<sf::Keyboard::Key>(key))};
+    return std::string{scancodeIdentifier(static_cast<sf::Keyboard::Scancode>(key))};
+}
+
+// Identifiers are accepted with or without their Key:: or Scan:: prefix
+template <typename Enum, typename Range>
+std::optional<std::int16_t> parseIdentifier(std::string name, const Range& range, std::string_view (*identifier)(Enum))
+{
+    const auto prefix = std::string{identifier(Enum::Unknown).substr(0, identifier(Enum::Unknown).find("::") + 2)};
+    if (name.compare(0, prefix.size(), prefix) != 0)
+        name = prefix + name;
+
+    if (name == identifier(Enum::Unknown))
+        return -1;
+    for (auto value : range)
+        if (identifier(value) == name)
+            return static_cast<std::int16_t>(value);
+
+    return std::nullopt;
+}
+
+template <typename Value>
+std::optional<Value> parseName(const std::string& name, std::size_t count, const char* (*nameOf)(Value))
+{
+    for (std::size_t i = 0; i < count; ++i)
+        if (name == nameOf(static_cast<Value>(i)))
+            return static_cast<Value>(i);
+
+    return std::nullopt;
+}
+
+std::optional<Query> parseArguments(int argc, char* argv[])
+{
+    auto       query = Query{};
+    const auto next  = [&](int& i) { return i + 1 < argc ? std::optional<std::string>{argv[++i]} : std::nullopt; };
+
+    for (int i = 1; i < argc; i++)
+    {
+        const auto arg = std::string{argv[i]};
+        auto       ok  = true;
+
+        if (arg == "--type")
+            ok = (query.filter.type = parseName(next(i).value_or(""), EventRecord::typeCount, typeName)).has_value();
+        else if (arg == "--code")
+            ok = (query.filter.code = parseIdentifier(next(i).value_or(""), keys, keyIdentifier)).has_value();
+        else if (arg == "--scancode")
+            ok = (query.filter.scancode = parseIdentifier(next(i).value_or(""), scancodes, scancodeIdentifier))
+                     .has_value();
+        else if (arg == "--localized")
+            ok = (query.filter.localized = parseIdentifier(next(i).value_or(""), keys, keyIdentifier)).has_value();
+        else if (arg == "--delocalized")
+            ok = (query.filter.delocalized = parseIdentifier(next(i).value_or(""), scancodes, scancodeIdentifier))
+                     .has_value();
+        else if (arg == "--flag")
+        {
+            const auto flag = parseName(next(i).value_or(""), EventRecord::flagCount, flagName);
+            ok              = flag.has_value();
+            query.filter.flags |= static_cast<std::uint16_t>(1 << flag.value_or(0));
+        }
+        else if (arg == "--count-by")
+            ok = countColumn(*(query.countBy = next(i).value_or(""))) != SessionArchive::Column{};
+        else if (arg == "--print")
+            query.print = true;
+        else if (arg == "-j" || arg == "--jobs")
+            ok = (query.jobs = static_cast<unsigned int>(std::atoi(next(i).value_or("0").c_str()))) > 0;
+        else if (arg.empty() || arg.front() == '-')
+            ok = false;
+        else
+            query.paths.emplace_back(arg);
+
+        if (!ok)
+        {
+            std::cout << "Error: invalid argument " << arg << '\n';
+            return std::nullopt;
+        }
+    }
+
+    if (query.paths.empty())
+        return std::nullopt;
+
+    return query;
+}
+
+std::vector<std::filesystem::path> findArchives(const std::vector<std::filesystem::path>& paths)
+{
+    auto archives = std::vector<std::filesystem::path>{};
+    for (const auto& path : paths)
+    {
+        auto error = std::error_code{};
+        if (!std::filesystem::is_directory(path, error))
+        {
+            archives.push_back(path);
+            continue;
+        }
+
+        // The unreadable directories are skipped, an error only ends the search of this path
+        const auto options = std::filesystem::directory_options::skip_permission_denied;
+        for (auto it = std::filesystem::recursive_directory_iterator{path, options, error};
+             !error && it != std::filesystem::recursive_directory_iterator{};
+             it.increment(error))
+        {
+            auto regular = std::error_code{};
+            if (it->is_regular_file(regular) && it->path().extension() == SessionArchive::extension)
+                archives.push_back(it->path());
+        }
+        if (error)
+            std::cout << "Error: cannot search " << path.string() << ": " << error.message() << '\n';
+    }
+
+    std::sort(archives.begin(), archives.end());
+    return archives;
+}
+
+// Streams through the archive block by block, decoding only the columns the query needs. The printed events go to a
+// temporary file rather than memory.
+Result scan(const std::filesystem::path& path, const Query& query)
+{
+    auto columns = query.filter.columns();
+    if (query.countBy)
+        columns |= countColumn(*query.countBy);
+    if (query.print)
+        columns = SessionArchive::AllColumns;
+
+    auto result  = Result{};
+    auto reader  = SessionArchive::Reader{path};
+    auto records = std::vector<EventRecord>{};
+    auto line    = std::string{};
+    if (query.print)
+        result.printed.reset(std::tmpfile());
+    while (reader.read(records, columns))
+    {
+        result.events += records.size();
+        for (const auto& record : records)
+        {
+            if (!query.filter.matches(record))
+                continue;
+
+            result.matches++;
+            if (result.printed)
+            {
+                line = format(record);
+                std::fwrite(line.data(), 1, line.size(), result.printed.get());
+            }
+
+            if (query.countBy == "flag")
+            {
+                for (std::size_t bit = 0; bit < EventRecord::flagCount; ++bit)
+                    if (record.flags & (1 << bit))
+                        result.counts[static_cast<std::int64_t>(bit)]++;
+            }
+            else if (query.countBy)
+            {
+                result.counts[countKey(*query.countBy, record)]++;
+            }
+        }
+    }
+    result.opened  = reader.isOpen();
+    result.corrupt = reader.isCorrupt();
+
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const auto query = parseArguments(argc, argv);
+    if (!query)
+    {
+        std::cout << "Usage: " << argv[0] << " [OPTION]... PATH...\n\n" << help << '\n';
+
+        return 1;
+    }
+
+    const auto archives = findArchives(query->paths);
+
+    // Files are handed out one at a time, so a few large sessions don't leave the other threads idle
+    auto results  = std::vector<Result>(archives.size());
+    auto scanned  = std::vector<bool>(archives.size());
+    auto mutex    = std::mutex{};
+    auto finished = std::condition_variable{};
+    auto next     = std::atomic<std::size_t>{0};
+    auto workers  = std::vector<std::thread>{};
+    for (unsigned int i = 0; i < std::min<std::size_t>(query->jobs, archives.size()); ++i)
+        workers.emplace_back(
+            [&]
+            {
+                for (auto index = next++; index < archives.size(); index = next++)
+                {
+                    auto result = scan(archives[index], *query);
+
+                    const auto lock = std::lock_guard{mutex};
+                    results[index]  = std::move(result);
+                    scanned[index]  = true;
+                    finished.notify_all();
+                }
+            });
+
+    // The output of each file is written as soon as it and the files before it are scanned
+    auto totals   = Result{};
+    auto sessions = std::size_t{0};
+    auto buffer   = std::vector<char>(1 << 16);
+    for (std::size_t i = 0; i < archives.size(); ++i)
+    {
+        auto lock = std::unique_lock{mutex};
+        finished.wait(lock, [&] { return scanned[i]; });
+        lock.unlock();
+
+        auto& result = results[i];
+        if (!result.opened)
+            std::cout << "Error: cannot open " << archives[i].string() << '\n';
+        else if (result.corrupt)
+            std::cout << "Error: " << archives[i].string() << " is corrupt after " << result.events << " events\n";
+
+        if (query->print && !result.printed)
+        {
+            std::cout << "Error: cannot create a temporary file for the events of " << archives[i].string() << '\n';
+        }
+        else if (query->print)
+        {
+            auto* const file = result.printed.get();
+            std::rewind(file);
+            while (const auto size = std::fread(buffer.data(), 1, buffer.size(), file))
+                std::cout.write(buffer.data(), static_cast<std::streamsize>(size));
+            result.printed.reset();
+        }
+        else if (!query->countBy && result.matches != 0)
+        {
+            std::cout << archives[i].string() << ": " << result.matches << " of " << result.events << " events\n";
+        }
+
+        totals.events += result.events;
+        totals.matches += result.matches;
+        for (const auto& [key, count] : result.counts)
+            totals.counts[key] += count;
+        sessions += result.matches != 0;
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    if (query->countBy)
+        for (const auto& [key, count] : totals.counts)
+            std::cout << countName(*query->countBy, key) << '\t' << count << '\n';
+
+    if (!query->print)
+        std::cout << sessions << " of " << archives.size() << " sessions, " << totals.matches << " of " << totals.events
+                  << " events match\n";
+
+    return 0;
+}
@@ -1,8 +1,14 @@
+#pragma once
+
 #include <SFML/Window/Keyboard.hpp>
 #include <SFML/Window/Mouse.hpp>
 
+#include <array>
 #include <type_traits>
 
+#include <cstddef>
+#include <cstdint>
+
 template <typename Enum>
 class EnumRange
 {
@@ -54,3 +60,254 @@ private:
 constexpr auto keys      = EnumRange<sf::Keyboard::Key>{0, sf::Keyboard::KeyCount};
 constexpr auto scancodes = EnumRange<sf::Keyboard::Scancode>{0, sf::Keyboard::ScancodeCount};
 constexpr auto buttons   = EnumRange<sf::Mouse::Button>{0, sf::Mouse::ButtonCount};
+
+// Number of values of the enums above, Unknown excluded
+template <typename Enum>
+constexpr std::size_t enumCount = 0;
+template <>
+constexpr std::size_t enumCount<sf::Keyboard::Key> = sf::Keyboard::KeyCount;
+template <>
+constexpr std::size_t enumCount<sf::Keyboard::Scancode> = sf::Keyboard::ScancodeCount;
+template <>
+constexpr std::size_t enumCount<sf::Mouse::Button> = sf::Mouse::ButtonCount;
+
+// Array with one value per enum value, indexing with Unknown is not allowed
+template <typename Enum, typename T>
+class EnumMap
+{
+public:
+    constexpr EnumMap() = default;
+
+    constexpr explicit EnumMap(const T& value)
+    {
+        fill(value);
+    }
+
+    constexpr T& operator[](Enum value)
+    {
+        return m_values[static_cast<std::size_t>(value)];
+    }
+    constexpr const T& operator[](Enum value) const
+    {
+        return m_values[static_cast<std::size_t>(value)];
+    }
+
+    constexpr void fill(const T& value)
+    {
+        for (auto& element : m_values)
+            element = value;
+    }
+
+    // Iterates over the values in enum order
+    constexpr auto begin()
+    {
+        return m_values.begin();
+    }
+    constexpr auto end()
+    {
+        return m_values.end();
+    }
+    constexpr auto begin() const
+    {
+        return m_values.begin();
+    }
+    constexpr auto end() const
+    {
+        return m_values.end();
+    }
+
+    static constexpr std::size_t size()
+    {
+        return enumCount<Enum>;
+    }
+
+private:
+    std::array<T, enumCount<Enum>> m_values{};
+};
+
+// Set of enum values packed in 64 bit words, iterating over it visits the values in the set in enum order
+template <typename Enum>
+class EnumBitset
+{
+    using Word = std::uint64_t;
+
+    static constexpr std::size_t wordBits  = 64;
+    static constexpr std::size_t wordCount = (enumCount<Enum> + wordBits - 1) / wordBits;
+    static constexpr Word        lastWordMask =
+        enumCount<Enum> % wordBits == 0 ? ~Word{0} : (Word{1} << enumCount<Enum> % wordBits) - 1;
+
+    using Words = std::array<Word, wordCount>;
+
+public:
+    class Iterator
+    {
+    public:
+        constexpr Iterator(const Words& words, std::size_t word) :
+        m_words{&words},
+        m_word{word},
+        m_bits{word < wordCount ? words[word] : 0}
+        {
+            skipEmptyWords();
+        }
+
+        constexpr Enum operator*() const
+        {
+            return static_cast<Enum>(m_word * wordBits + countTrailingZeros(m_bits));
+        }
+        constexpr Iterator& operator++()
+        {
+            m_bits &= m_bits - 1;
+            skipEmptyWords();
+            return *this;
+        }
+        constexpr bool operator!=(const Iterator& other) const
+        {
+            return m_word != other.m_word || m_bits != other.m_bits;
+        }
+
+    private:
+        constexpr void skipEmptyWords()
+        {
+            while (m_bits == 0 && m_word < wordCount)
+                m_bits = ++m_word < wordCount ? (*m_words)[m_word] : 0;
+        }
+
+        const Words* m_words;
+        std::size_t  m_word;
+        Word         m_bits; // bits of the current word which were not visited yet
+    };
+
+    constexpr bool operator[](Enum value) const
+    {
+        return test(value);
+    }
+    constexpr bool test(Enum value) const
+    {
+        return (m_words[wordIndex(value)] & bit(value)) != 0;
+    }
+
+    constexpr EnumBitset& set(Enum value, bool enabled = true)
+    {
+        if (enabled)
+            m_words[wordIndex(value)] |= bit(value);
+        else
+            m_words[wordIndex(value)] &= ~bit(value);
+        return *this;
+    }
+    constexpr EnumBitset& reset(Enum value)
+    {
+        return set(value, false);
+    }
+    constexpr EnumBitset& reset()
+    {
+        for (auto& word : m_words)
+            word = 0;
+        return *this;
+    }
+
+    constexpr std::size_t count() const
+    {
+        auto count = std::size_t{0};
+        for (const auto word : m_words)
+            count += popcount(word);
+        return count;
+    }
+    constexpr bool any() const
+    {
+        for (const auto word : m_words)
+            if (word != 0)
+                return true;
+        return false;
+    }
+    constexpr bool none() const
+    {
+        return !any();
+    }
+
+    constexpr EnumBitset& operator&=(const EnumBitset& other)
+    {
+        for (std::size_t i = 0; i < wordCount; ++i)
+            m_words[i] &= other.m_words[i];
+        return *this;
+    }
+    constexpr EnumBitset& operator|=(const EnumBitset& other)
+    {
+        for (std::size_t i = 0; i < wordCount; ++i)
+            m_words[i] |= other.m_words[i];
+        return *this;
+    }
+    constexpr EnumBitset operator~() const
+    {
+        auto result = EnumBitset{};
+        for (std::size_t i = 0; i < wordCount; ++i)
+            result.m_words[i] = ~m_words[i];
+        result.m_words[wordCount - 1] &= lastWordMask;
+        return result;
+    }
+
+    friend constexpr EnumBitset operator&(EnumBitset left, const EnumBitset& right)
+    {
+        return left &= right;
+    }
+    friend constexpr EnumBitset operator|(EnumBitset left, const EnumBitset& right)
+    {
+        return left |= right;
+    }
+    friend constexpr bool operator==(const EnumBitset& left, const EnumBitset& right)
+    {
+        for (std::size_t i = 0; i < wordCount; ++i)
+            if (left.m_words[i] != right.m_words[i])
+                return false;
+        return true;
+    }
+    friend constexpr bool operator!=(const EnumBitset& left, const EnumBitset& right)
+    {
+        return !(left == right);
+    }
+
+    constexpr Iterator begin() const
+    {
+        return Iterator{m_words, 0};
+    }
+    constexpr Iterator end() const
+    {
+        return Iterator{m_words, wordCount};
+    }
+
+private:
+    static constexpr std::size_t wordIndex(Enum value)
+    {
+        return static_cast<std::size_t>(value) / wordBits;
+    }
+    static constexpr Word bit(Enum value)
+    {
+        return Word{1} << static_cast<std::size_t>(value) % wordBits;
+    }
+
+    static constexpr std::size_t popcount(Word word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<std::size_t>(__builtin_popcountll(word));
+#else
+        word = word - ((word >> 1) & 0x5555555555555555);
+        word = (word & 0x3333333333333333) + ((word >> 2) & 0x3333333333333333);
+        word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0f;
+        return static_cast<std::size_t>((word * 0x0101010101010101) >> 56);
+#endif
+    }
+
+    // Word must not be 0
+    static constexpr std::size_t countTrailingZeros(Word word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<std::size_t>(__builtin_ctzll(word));
+#else
+        auto count = std::size_t{0};
+        for (; (word & 1) == 0; word >>= 1)
+            ++count;
+        return count;
+#endif
+    }
+
+    Words m_words{};
+};
@@ -0,0 +1,142 @@
+#include "EventRecord.hpp"
+#include "SharedState.hpp"
+#include "ranges.hpp"
+#include "strings.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+constexpr auto help =
+    "Print the input state published by SFML-Input --shm NAME\n\n"
+    "  -f, --follow  Keep printing new events\n"
+    "  -h, --help    Show help and exit";
+
+const SharedState* open(std::string name)
+{
+    if (name.front() != '/')
+        name.insert(name.begin(), '/');
+
+    const auto descriptor = shm_open(name.c_str(), O_RDONLY, 0);
+    if (descriptor == -1)
+        return nullptr;
+
+    struct stat status = {};
+    void*       address = MAP_FAILED;
+    if (fstat(descriptor, &status) == 0 && static_cast<std::size_t>(status.st_size) >= sizeof(SharedState))
+        address = mmap(nullptr, sizeof(SharedState), PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+
+    if (address == MAP_FAILED)
+        return nullptr;
+
+    const auto* shared = static_cast<const SharedState*>(address);
+    if (shared->magic != SharedState::magicNumber || shared->version != SharedState::layoutVersion)
+        return nullptr;
+
+    return shared;
+}
+
+void printState(std::ostream& os, const SharedState::State& state)
+{
+    os << "Pressed:";
+    for (auto scancode : scancodes)
+        if (SharedState::isSet(state, static_cast<std::size_t>(scancode)))
+            os << " sf::Keyboard::" << scancodeIdentifier(scancode);
+    for (auto button : buttons)
+        if (SharedState::isSet(state, sf::Keyboard::ScancodeCount + static_cast<std::size_t>(button)))
+            os << " sf::Mouse::" << buttonIdentifier(button);
+    os << '\n';
+}
+
+// Returns the index of the next event to print
+SharedState::Word printEvents(std::ostream& os, const SharedState& shared, SharedState::Word next)
+{
+    const auto count = shared.eventCount.load(std::memory_order_acquire);
+    if (count - next > SharedState::eventCapacity)
+    {
+        os << "... " << count - next - SharedState::eventCapacity << " events overwritten\n";
+        next = count - SharedState::eventCapacity;
+    }
+
+    for (auto record = EventRecord{}; next < count; ++next)
+    {
+        const auto read = shared.readEvent(next, record);
+        if (read == SharedState::Read::Done)
+            os << format(record);
+        else if (read == SharedState::Read::Missing)
+            os << "... event " << next << " overwritten while reading\n";
+        else
+            os << "... event " << next << " torn, the publisher stopped while writing it\n";
+    }
+
+    return next;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto name     = std::string{};
+    auto follow   = false;
+    auto showHelp = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const auto arg = std::string{argv[i]};
+        if (arg == "-f" || arg == "--follow")
+            follow = true;
+        else if (!arg.empty() && arg.front() != '-' && name.empty())
+            name = arg;
+        else
+            showHelp = true;
+    }
+
+    if (showHelp || name.empty())
+    {
+        std::cout << "Usage: " << argv[0] << " [OPTION]... NAME\n\n" << help << '\n';
+
+        return 1;
+    }
+
+    const auto* shared = open(name);
+    if (!shared)
+    {
+        std::cout << "Error: no input state published as " << name << '\n';
+
+        return 1;
+    }
+
+    if (const auto state = shared->readState())
+    {
+        printState(std::cout, *state);
+    }
+    else
+    {
+        std::cout << "Error: torn state, the publisher stopped while writing it\n";
+
+        return 1;
+    }
+
+    // Start with the events still in the ring
+    const auto count = shared->eventCount.load(std::memory_order_acquire);
+    auto       next  = count > SharedState::eventCapacity ? count - SharedState::eventCapacity : 0;
+    next             = printEvents(std::cout, *shared, next);
+
+    // Polling is enough for a terminal, the publisher never waits for readers anyway
+    while (follow)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        next = printEvents(std::cout, *shared, next);
+        std::cout.flush();
+    }
+
+    return 0;
+}
@@ -1,27 +1,25 @@
 #include "strings.hpp"
 
+#include <iterator>
 #include <stdexcept>
 
-std::string encodeStringToAnsi(const sf::String& string)
+void encodeStringToAnsi(std::ostream& os, std::u32string_view string)
 {
-    return string.toAnsiString();
+    // Characters which have no ANSI equivalent are skipped, as sf::String::toAnsiString does
+    sf::Utf32::toAnsi(string.begin(), string.end(), std::ostreambuf_iterator<char>{os}, 0);
 }
 
-std::string encodeStringToUtf8(const sf::String& string)
+void encodeStringToUtf8(std::ostream& os, std::u32string_view string)
 {
-    // sf::String::toUtf8 returns std::basic_string<sf::Uint8>
-    // which cannot be converted cheaply to std::basic_string<char>
-    // so the conversion is done with sf::Utf32::toUtf8 here.
-
-    std::string output;
-    output.reserve(string.getSize());
-
-    sf::Utf32::toUtf8(string.begin(), string.end(), std::back_inserter(output));
+    sf::Utf32::toUtf8(string.begin(), string.end(), std::ostreambuf_iterator<char>{os});
+}
 
-    return output;
+std::u32string_view toView(const sf::String& string)
+{
+    return {string.getData(), string.getSize()};
 }
 
-std::string keyIdentifier(sf::Keyboard::Key code)
+std::string_view keyIdentifier(sf::Keyboard::Key code)
 {
     // Inspired by mantognini/SFML-Test-Events
 
@@ -142,7 +140,7 @@ std::string keyIdentifier(sf::Keyboard::Key code)
     throw std::runtime_error{"invalid keyboard code"};
 }
 
-std::string scancodeIdentifier(sf::Keyboard::Scancode scancode)
+std::string_view scancodeIdentifier(sf::Keyboard::Scancode scancode)
 {
     // Same design as the keyIdentifier function
 
@@ -307,7 +305,7 @@ std::string scancodeIdentifier(sf::Keyboard::Scancode scancode)
     throw std::runtime_error{"invalid keyboard scancode"};
 }
 
-std::string buttonIdentifier(sf::Mouse::Button button)
+std::string_view buttonIdentifier(sf::Mouse::Button button)
 {
     // Same design as the keyIdentifier function
 
@@ -5,12 +5,17 @@
 
 #include <SFML/System/String.hpp>
 
+#include <ostream>
 #include <string>
+#include <string_view>
 
-using Encoder = std::string (*)(const sf::String&);
-std::string encodeStringToAnsi(const sf::String& string);
-std::string encodeStringToUtf8(const sf::String& string);
+// Encoders write straight to the stream, without building a copy of the string
+using Encoder = void (*)(std::ostream& os, std::u32string_view string);
+void encodeStringToAnsi(std::ostream& os, std::u32string_view string);
+void encodeStringToUtf8(std::ostream& os, std::u32string_view string);
 
-std::string keyIdentifier(sf::Keyboard::Key code);
-std::string scancodeIdentifier(sf::Keyboard::Scancode scancode);
-std::string buttonIdentifier(sf::Mouse::Button button);
+std::u32string_view toView(const sf::String& string);
+
+std::string_view keyIdentifier(sf::Keyboard::Key code);
+std::string_view scancodeIdentifier(sf::Keyboard::Scancode scancode);
+std::string_view buttonIdentifier(sf::Mouse::Button button);